@@ -0,0 +1,158 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// ==========================================================================
+// INSTRUMENTATION - shared by sorting.cpp and searching.cpp
+// Algorithms take a Stats policy as their last argument, defaulting to
+// NullStats, whose empty inline members compile to nothing. Passing an
+// OpStats instead counts the operations of that one call:
+//
+//     OpStats stats;
+//     binarySearch(arr, target, stats);   // stats.comparisons, stats.probes
+//
+// PerfCounters reads hardware counters around any call on Linux.
+// ==========================================================================
+
+// Disabled instrumentation: every hook is a no-op the optimizer removes
+struct NullStats {
+    static constexpr bool enabled = false;
+    
+    void comparison(uint64_t = 1) {}
+    void swap(uint64_t = 1) {}
+    void move(uint64_t = 1) {}
+    void allocation(size_t) {}
+    void probe(uint64_t = 1) {}
+    void decision(const char*, const char*) {}
+};
+
+// Operation counts of one call (or of several, until reset)
+struct OpStats {
+    static constexpr bool enabled = true;
+    
+    uint64_t comparisons = 0;        // Key comparisons
+    uint64_t swaps = 0;              // Element exchanges
+    uint64_t moves = 0;              // Single element writes (shifts, copies)
+    uint64_t bytesAllocated = 0;     // Heap bytes requested for temporaries (workspace growth)
+    uint64_t probes = 0;             // Array elements read while searching
+    const char* algorithm = nullptr; // What a dispatcher such as autoSort chose
+    const char* reason = nullptr;    // and why
+    
+    void comparison(uint64_t count = 1) { comparisons += count; }
+    void swap(uint64_t count = 1) { swaps += count; }
+    void move(uint64_t count = 1) { moves += count; }
+    void allocation(size_t bytes) { bytesAllocated += bytes; }
+    void probe(uint64_t count = 1) { probes += count; }
+    
+    void decision(const char* chosen, const char* why) {
+        algorithm = chosen;
+        reason = why;
+    }
+    
+    void reset() { *this = OpStats(); }
+};
+
+// Hardware counters of the calling thread: cycles, branch misses, cache
+// misses and last-level-cache read misses. Counters the kernel refuses
+// (no PMU, perf_event_paranoid, containers) read as unavailable; on other
+// platforms every counter is unavailable.
+class PerfCounters {
+public:
+    enum Event { CYCLES, BRANCH_MISSES, CACHE_MISSES, LLC_MISSES, EVENT_COUNT };
+    
+    static const char* name(int event) {
+        static const char* names[EVENT_COUNT] = {"cycles", "branch-misses", "cache-misses", "LLC-misses"};
+        return names[event];
+    }
+    
+    PerfCounters() {
+        for (int e = 0; e < EVENT_COUNT; e++) {
+            fd[e] = -1;
+            values[e] = 0;
+        }
+#ifdef __linux__
+        const uint32_t types[EVENT_COUNT] = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+                                             PERF_TYPE_HW_CACHE};
+        const uint64_t configs[EVENT_COUNT] = {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_HW_CACHE_MISSES,
+            PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)};
+        
+        for (int e = 0; e < EVENT_COUNT; e++) {
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = types[e];
+            attr.config = configs[e];
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fd[e] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        }
+#endif
+    }
+    
+    ~PerfCounters() {
+#ifdef __linux__
+        for (int e = 0; e < EVENT_COUNT; e++)
+            if (fd[e] >= 0) close(fd[e]);
+#endif
+    }
+    
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+    
+    bool available(int event) const { return fd[event] >= 0; }
+    
+    bool anyAvailable() const {
+        for (int e = 0; e < EVENT_COUNT; e++)
+            if (available(e)) return true;
+        return false;
+    }
+    
+    void start() {
+#ifdef __linux__
+        for (int e = 0; e < EVENT_COUNT; e++) {
+            if (fd[e] < 0) continue;
+            ioctl(fd[e], PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd[e], PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+    
+    void stop() {
+#ifdef __linux__
+        for (int e = 0; e < EVENT_COUNT; e++) {
+            if (fd[e] < 0) continue;
+            ioctl(fd[e], PERF_EVENT_IOC_DISABLE, 0);
+            if (read(fd[e], &values[e], sizeof(values[e])) != sizeof(values[e])) values[e] = 0;
+        }
+#endif
+    }
+    
+    // Count from the last start/stop pair
+    uint64_t value(int event) const { return values[event]; }
+    
+    // Runs f between start and stop
+    template <typename F>
+    void measure(F&& f) {
+        start();
+        std::forward<F>(f)();
+        stop();
+    }
+
+private:
+    int fd[EVENT_COUNT];
+    uint64_t values[EVENT_COUNT];
+};
+
+#endif
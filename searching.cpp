@@ -5,6 +5,7 @@
 #include <unordered_set>
 #include <cmath>
 #include <climits>
+#include "instrumentation.h"
 using namespace std;
 
 void printArray(const vector<int>& arr, const string& title) {
@@ -32,8 +33,11 @@ void printResult(const string& algorithm, int target, int result, int comparison
 // Sequential search through array, works on unsorted data
 // ==========================================================================
 
-int linearSearch(vector<int>& arr, int target) {
+template <typename Stats = NullStats>
+int linearSearch(vector<int>& arr, int target, Stats&& stats = Stats()) {
     for (int i = 0; i < arr.size(); i++) {
+        stats.probe();
+        stats.comparison();
         if (arr[i] == target) {
             return i;
         }
@@ -43,14 +47,10 @@ int linearSearch(vector<int>& arr, int target) {
 
 // Linear Search with comparison count
 int linearSearchWithCount(vector<int>& arr, int target, int& comparisons) {
-    comparisons = 0;
-    for (int i = 0; i < arr.size(); i++) {
-        comparisons++;
-        if (arr[i] == target) {
-            return i;
-        }
-    }
-    return -1;
+    OpStats stats;
+    int result = linearSearch(arr, target, stats);
+    comparisons = stats.comparisons;
+    return result;
 }
 
 // Linear Search - Find all occurrences
@@ -69,11 +69,15 @@ vector<int> linearSearchAll(vector<int>& arr, int target) {
 // Works only on sorted arrays, divides search space in half
 // ==========================================================================
 
-int binarySearch(vector<int>& arr, int target) {
+// Each probe is one three-way comparison of arr[mid] with target
+template <typename Stats = NullStats>
+int binarySearch(vector<int>& arr, int target, Stats&& stats = Stats()) {
     int left = 0, right = arr.size() - 1;
     
     while (left <= right) {
         int mid = left + (right - left) / 2;
+        stats.probe();
+        stats.comparison();
         
         if (arr[mid] == target) {
             return mid;
@@ -91,25 +95,10 @@ int binarySearch(vector<int>& arr, int target) {
 
 // Binary Search with comparison count
 int binarySearchWithCount(vector<int>& arr, int target, int& comparisons) {
-    int left = 0, right = arr.size() - 1;
-    comparisons = 0;
-    
-    while (left <= right) {
-        int mid = left + (right - left) / 2;
-        comparisons++;
-        
-        if (arr[mid] == target) {
-            return mid;
-        }
-        
-        if (arr[mid] < target) {
-            left = mid + 1;
-        } else {
-            right = mid - 1;
-        }
-    }
-    
-    return -1;
+    OpStats stats;
+    int result = binarySearch(arr, target, stats);
+    comparisons = stats.comparisons;
+    return result;
 }
 
 // Binary Search - Recursive Implementation
@@ -196,20 +185,25 @@ int countOccurrences(vector<int>& arr, int target) {
 // Divides search space into three parts, works on sorted arrays
 // ==========================================================================
 
-int ternarySearch(vector<int>& arr, int target) {
+template <typename Stats = NullStats>
+int ternarySearch(vector<int>& arr, int target, Stats&& stats = Stats()) {
     int left = 0, right = arr.size() - 1;
     
     while (left <= right) {
         int mid1 = left + (right - left) / 3;
         int mid2 = right - (right - left) / 3;
+        stats.probe(2);
         
+        stats.comparison();
         if (arr[mid1] == target) {
             return mid1;
         }
+        stats.comparison();
         if (arr[mid2] == target) {
             return mid2;
         }
         
+        stats.comparison();
         if (target < arr[mid1]) {
             right = mid1 - 1;
         } else if (target > arr[mid2]) {
@@ -225,35 +219,10 @@ int ternarySearch(vector<int>& arr, int target) {
 
 // Ternary Search with comparison count
 int ternarySearchWithCount(vector<int>& arr, int target, int& comparisons) {
-    int left = 0, right = arr.size() - 1;
-    comparisons = 0;
-    
-    while (left <= right) {
-        int mid1 = left + (right - left) / 3;
-        int mid2 = right - (right - left) / 3;
-        
-        comparisons++;
-        if (arr[mid1] == target) {
-            return mid1;
-        }
-        
-        comparisons++;
-        if (arr[mid2] == target) {
-            return mid2;
-        }
-        
-        comparisons++;
-        if (target < arr[mid1]) {
-            right = mid1 - 1;
-        } else if (target > arr[mid2]) {
-            left = mid2 + 1;
-        } else {
-            left = mid1 + 1;
-            right = mid2 - 1;
-        }
-    }
-    
-    return -1;
+    OpStats stats;
+    int result = ternarySearch(arr, target, stats);
+    comparisons = stats.comparisons;
+    return result;
 }
 
 // ==========================================================================
@@ -261,13 +230,15 @@ int ternarySearchWithCount(vector<int>& arr, int target, int& comparisons) {
 // Jumps ahead by fixed steps, then linear search in block
 // ==========================================================================
 
-int jumpSearch(vector<int>& arr, int target) {
+template <typename Stats = NullStats>
+int jumpSearch(vector<int>& arr, int target, Stats&& stats = Stats()) {
     int n = arr.size();
     int step = sqrt(n);
     int prev = 0;
     
     // Find the block where element is present
-    while (arr[min(step, n) - 1] < target) {
+    while (stats.probe(), arr[min(step, n) - 1] < target) {
+        stats.comparison();
         prev = step;
         step += sqrt(n);
         if (prev >= n) {
@@ -276,13 +247,15 @@ int jumpSearch(vector<int>& arr, int target) {
     }
     
     // Linear search in the identified block
-    while (arr[prev] < target) {
+    while (stats.probe(), arr[prev] < target) {
+        stats.comparison();
         prev++;
         if (prev == min(step, n)) {
             return -1;
         }
     }
     
+    stats.comparison();
     if (arr[prev] == target) {
         return prev;
     }
@@ -292,36 +265,10 @@ int jumpSearch(vector<int>& arr, int target) {
 
 // Jump Search with comparison count
 int jumpSearchWithCount(vector<int>& arr, int target, int& comparisons) {
-    int n = arr.size();
-    int step = sqrt(n);
-    int prev = 0;
-    comparisons = 0;
-    
-    // Find the block where element is present
-    while (arr[min(step, n) - 1] < target) {
-        comparisons++;
-        prev = step;
-        step += sqrt(n);
-        if (prev >= n) {
-            return -1;
-        }
-    }
-    
-    // Linear search in the identified block
-    while (arr[prev] < target) {
-        comparisons++;
-        prev++;
-        if (prev == min(step, n)) {
-            return -1;
-        }
-    }
-    
-    comparisons++;
-    if (arr[prev] == target) {
-        return prev;
-    }
-    
-    return -1;
+    OpStats stats;
+    int result = jumpSearch(arr, target, stats);
+    comparisons = stats.comparisons;
+    return result;
 }
 
 // ==========================================================================
@@ -329,22 +276,36 @@ int jumpSearchWithCount(vector<int>& arr, int target, int& comparisons) {
 // Better than binary search for uniformly distributed data
 // ==========================================================================
 
-int interpolationSearch(vector<int>& arr, int target) {
+template <typename Stats = NullStats>
+int interpolationSearch(vector<int>& arr, int target, Stats&& stats = Stats()) {
     int low = 0, high = arr.size() - 1;
     
-    while (low <= high && target >= arr[low] && target <= arr[high]) {
+    while (low <= high) {
+        // Outside [arr[low], arr[high]] the target cannot be present
+        stats.probe();
+        stats.comparison();
+        if (target < arr[low]) break;
+        
+        stats.probe();
+        stats.comparison();
+        if (target > arr[high]) break;
+        
         if (low == high) {
+            stats.comparison();
             if (arr[low] == target) return low;
             return -1;
         }
         
         // Calculate position using interpolation formula
         int pos = low + (double)(target - arr[low]) / (arr[high] - arr[low]) * (high - low);
+        stats.probe();
+        stats.comparison();
         
         if (arr[pos] == target) {
             return pos;
         }
         
+        stats.comparison();
         if (arr[pos] < target) {
             low = pos + 1;
         } else {
@@ -360,17 +321,20 @@ int interpolationSearch(vector<int>& arr, int target) {
 // Find range then binary search, good for infinite arrays
 // ==========================================================================
 
-int exponentialSearch(vector<int>& arr, int target) {
+template <typename Stats = NullStats>
+int exponentialSearch(vector<int>& arr, int target, Stats&& stats = Stats()) {
     int n = arr.size();
     
     // If element is at first position
+    stats.probe();
+    stats.comparison();
     if (arr[0] == target) {
         return 0;
     }
     
     // Find range for binary search
     int i = 1;
-    while (i < n && arr[i] <= target) {
+    while (i < n && (stats.probe(), stats.comparison(), arr[i] <= target)) {
         i = i * 2;
     }
     
@@ -380,6 +344,8 @@ int exponentialSearch(vector<int>& arr, int target) {
     
     while (left <= right) {
         int mid = left + (right - left) / 2;
+        stats.probe();
+        stats.comparison();
         
         if (arr[mid] == target) {
             return mid;
@@ -400,7 +366,8 @@ int exponentialSearch(vector<int>& arr, int target) {
 // Uses Fibonacci numbers to divide array, no division/multiplication
 // ==========================================================================
 
-int fibonacciSearch(vector<int>& arr, int target) {
+template <typename Stats = NullStats>
+int fibonacciSearch(vector<int>& arr, int target, Stats&& stats = Stats()) {
     int n = arr.size();
     
     // Initialize fibonacci numbers
@@ -419,6 +386,8 @@ int fibonacciSearch(vector<int>& arr, int target) {
     
     while (fibM > 1) {
         int i = min(offset + fibM2, n - 1);
+        stats.probe();
+        stats.comparison();
         
         if (arr[i] < target) {
             fibM = fibM1;
@@ -434,7 +403,7 @@ int fibonacciSearch(vector<int>& arr, int target) {
         }
     }
     
-    if (fibM1 && offset + 1 < n && arr[offset + 1] == target) {
+    if (fibM1 && offset + 1 < n && (stats.probe(), stats.comparison(), arr[offset + 1] == target)) {
         return offset + 1;
     }
     
@@ -449,7 +418,7 @@ int fibonacciSearch(vector<int>& arr, int target) {
 class HashSearch {
 private:
     unordered_map<int, vector<int>> hashTable;
-    
+
 public:
     void buildHashTable(vector<int>& arr) {
         hashTable.clear();
@@ -735,6 +704,35 @@ int main() {
     int minPages = BinarySearchOnAnswer::allocateBooks(books, 2);
     cout << "    Book allocation (2 students): " << minPages << " pages" << endl;
     
+    // Operation counts and hardware counters from the same implementations
+    cout << "\nINSTRUMENTED SEARCHES (1M evenly spaced ints, 1000 lookups)" << endl;
+    
+    vector<int> large(1 << 20);
+    for (int i = 0; i < (int)large.size(); i++) large[i] = 3 * i;
+    vector<int> lookups(1000);
+    for (int i = 0; i < (int)lookups.size(); i++) lookups[i] = 3 * ((i * 7919) % (int)large.size());
+    
+    OpStats binaryStats, interpolationStats, exponentialStats, fibonacciStats;
+    PerfCounters perf;
+    perf.start();
+    for (int x : lookups) binarySearch(large, x, binaryStats);
+    perf.stop();
+    for (int x : lookups) {
+        interpolationSearch(large, x, interpolationStats);
+        exponentialSearch(large, x, exponentialStats);
+        fibonacciSearch(large, x, fibonacciStats);
+    }
+    
+    cout << "    Probes per lookup: binary " << binaryStats.probes / lookups.size()
+         << ", interpolation " << interpolationStats.probes / lookups.size()
+         << ", exponential " << exponentialStats.probes / lookups.size()
+         << ", fibonacci " << fibonacciStats.probes / lookups.size() << endl;
+    cout << "    Binary search hardware counters:";
+    if (!perf.anyAvailable()) cout << " unavailable (perf_event_open not permitted)";
+    for (int e = 0; e < PerfCounters::EVENT_COUNT; e++)
+        if (perf.available(e)) cout << " " << PerfCounters::name(e) << "=" << perf.value(e);
+    cout << endl;
+    
     cout << "\n" << string(60, '=') << endl;
     cout << "ALGORITHM COMPARISON SUMMARY" << endl;
     cout << string(60, '=') << endl;
@@ -1,9 +1,39 @@
 #include <iostream>
 #include <vector>
 #include <algorithm>
-#include <stack>
 #include <cstdlib>
 #include <ctime>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <climits>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <numeric>
+#include <queue>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+#include "instrumentation.h"
 using namespace std;
 
 void printArray(const vector<int>& arr, const string& title) {
@@ -14,12 +44,402 @@ void printArray(const vector<int>& arr, const string& title) {
     cout << endl;
 }
 
+// Leaf case of the divide-and-conquer sorts: branch-free sorting network for
+// up to SORTING_NETWORK_MAX ints (defined in section 16)
+const int SORTING_NETWORK_MAX = 64;
+void sortSmallBlock(int* arr, int n);
+
+// Fallback of counting sort for wide key ranges (defined in section 8)
+void radixSort(vector<int>& arr);
+
+// Leaf case of the parallel quick sort (defined in section 14)
+void pdqSortRange(vector<int>& arr, int low, int high);
+
+// Threading shared by the parallel sorts
+const int PARALLEL_SORT_CUTOFF = 1 << 14; // Below this size, stay on one thread
+const chrono::microseconds POOL_WAIT_SPIN(50); // Spinning on stolen tasks before sleeping
+
+int sortThreadCount() {
+    int threads = thread::hardware_concurrency();
+    return threads > 0 ? threads : 1;
+}
+
+// Fixed pool of sortThreadCount() - 1 workers, started on first use and
+// shared by every parallel sort. Each worker owns a deque: it pushes and
+// pops its own tasks at the back, while idle workers steal the oldest
+// (largest) task from the front of another deque. Threads outside the
+// pool submit to one extra shared deque. A thread waiting for a group of
+// tasks runs queued tasks instead of blocking, so tasks can spawn and
+// wait for tasks of their own. Once nothing is left to run it spins
+// briefly, then sleeps until the last task of the group finishes.
+class WorkStealingPool {
+public:
+    // Tasks that are waited for together
+    struct TaskGroup {
+        atomic<int> pending{0};
+        mutex lock;
+        condition_variable done;
+    };
+    
+    static WorkStealingPool& instance() {
+        static WorkStealingPool pool(sortThreadCount() - 1);
+        return pool;
+    }
+    
+    template <typename Task>
+    void submit(TaskGroup& group, Task task) {
+        group.pending++;
+        
+        Deque& deque = deques[home()];
+        {
+            lock_guard<mutex> lock(deque.lock);
+            deque.tasks.push_back({&group, function<void()>(std::move(task))});
+        }
+        
+        queued++;
+        {
+            lock_guard<mutex> lock(sleepLock);
+        }
+        wake.notify_one();
+        
+        // A sleeping waiter of the group can help with the new task
+        {
+            lock_guard<mutex> lock(group.lock);
+        }
+        group.done.notify_all();
+    }
+    
+    void wait(TaskGroup& group) {
+        auto spinUntil = chrono::steady_clock::now() + POOL_WAIT_SPIN;
+        while (group.pending.load() > 0) {
+            if (runOne()) {
+                spinUntil = chrono::steady_clock::now() + POOL_WAIT_SPIN;
+            } else if (chrono::steady_clock::now() < spinUntil) {
+                this_thread::yield();
+            } else {
+                // Only stolen tasks are left; sleep until they finish or
+                // queue more work
+                unique_lock<mutex> lock(group.lock);
+                group.done.wait(lock, [&] { return group.pending.load() == 0 || queued.load() > 0; });
+                spinUntil = chrono::steady_clock::now() + POOL_WAIT_SPIN;
+            }
+        }
+        
+        // The last task may still be inside finish(); the group must
+        // outlive it
+        lock_guard<mutex> lock(group.lock);
+    }
+    
+    ~WorkStealingPool() {
+        {
+            lock_guard<mutex> lock(sleepLock);
+            stopping = true;
+        }
+        wake.notify_all();
+        
+        for (thread& worker : workers)
+            worker.join();
+    }
+
+private:
+    struct Task {
+        TaskGroup* group;
+        function<void()> run;
+    };
+    
+    struct Deque {
+        mutex lock;
+        deque<Task> tasks;
+    };
+    
+    vector<thread> workers;
+    vector<Deque> deques; // One per worker, then the shared one
+    atomic<int> queued{0};
+    mutex sleepLock;
+    condition_variable wake;
+    bool stopping = false;
+    
+    static int& workerIndex() {
+        static thread_local int index = -1;
+        return index;
+    }
+    
+    int home() const { return workerIndex() >= 0 ? workerIndex() : (int)deques.size() - 1; }
+    
+    explicit WorkStealingPool(int workerCount) : deques(workerCount + 1) {
+        workers.reserve(workerCount);
+        for (int w = 0; w < workerCount; w++)
+            workers.emplace_back([this, w] {
+                workerIndex() = w;
+                while (true) {
+                    if (runOne()) continue;
+                    
+                    unique_lock<mutex> lock(sleepLock);
+                    wake.wait(lock, [this] { return queued.load() > 0 || stopping; });
+                    if (stopping) return;
+                }
+            });
+    }
+    
+    // Runs the newest task of the own deque, else steals the oldest of
+    // another; false if every deque was empty
+    bool runOne() {
+        int count = deques.size(), own = home();
+        Task task;
+        bool found = false;
+        
+        for (int i = 0; i < count && !found; i++) {
+            Deque& deque = deques[(own + i) % count];
+            lock_guard<mutex> lock(deque.lock);
+            if (deque.tasks.empty()) continue;
+            
+            if (i == 0) {
+                task = std::move(deque.tasks.back());
+                deque.tasks.pop_back();
+            } else {
+                task = std::move(deque.tasks.front());
+                deque.tasks.pop_front();
+            }
+            found = true;
+        }
+        
+        if (!found) return false;
+        
+        queued--;
+        task.run();
+        finish(*task.group);
+        return true;
+    }
+    
+    // Counts a task of group as done under its lock, so that a waiter
+    // cannot miss the wakeup or free the group while it is notified
+    static void finish(TaskGroup& group) {
+        lock_guard<mutex> lock(group.lock);
+        if (--group.pending == 0) group.done.notify_all();
+    }
+};
+
+// Runs task(0) .. task(count - 1) on the pool, task(0) on the calling thread
+template <typename Task>
+void runParallel(int count, Task task) {
+    WorkStealingPool& pool = WorkStealingPool::instance();
+    WorkStealingPool::TaskGroup group;
+    
+    for (int t = 1; t < count; t++)
+        pool.submit(group, [&task, t] { task(t); });
+    
+    task(0);
+    pool.wait(group);
+}
+
+// Scratch memory for the sorts' temporary arrays. Every thread has its own
+// workspace (SortWorkspace::local()): a stack of large blocks that
+// ScratchBuffer carves its arrays from and hands them back to, last in
+// first out, when it goes out of scope. Blocks outlive the sort, so once a
+// workspace has grown to fit the largest sort it serves, further sorts
+// allocate nothing, up to a retention limit: what an idle workspace holds
+// beyond it goes back to the allocator, so one large sort does not pin its
+// scratch for the life of the thread. Blocks can be backed by huge pages,
+// which saves page faults and TLB misses on large buffers.
+const int CACHE_LINE_BYTES = 64;
+
+class SortWorkspace {
+public:
+    static const size_t MIN_BLOCK_BYTES = 64 << 10;
+    static const size_t HUGE_PAGE_BYTES = 2 << 20;
+    static const size_t DEFAULT_RETAIN_BYTES = 16 << 20;
+    
+    // Position to go back to when an array is released
+    struct Mark {
+        size_t block, offset;
+    };
+    
+    explicit SortWorkspace(bool hugePages = false) : hugePages(hugePages) {}
+    SortWorkspace(const SortWorkspace&) = delete;
+    SortWorkspace& operator=(const SortWorkspace&) = delete;
+    ~SortWorkspace() { trim(); }
+    
+    static SortWorkspace& local() {
+        static thread_local SortWorkspace workspace;
+        return workspace;
+    }
+    
+    // Most bytes a workspace keeps once idle. Shared by every thread's
+    // workspace, pool workers included.
+    static void setRetainLimit(size_t bytes) { retainLimit() = bytes; }
+    
+    // Takes effect for blocks allocated from now on
+    void setHugePages(bool enable) { hugePages = enable; }
+    
+    size_t capacity() const {
+        size_t bytes = 0;
+        for (const Block& b : blocks) bytes += b.size;
+        return bytes;
+    }
+    
+    // Bytes of blocks allocated over the workspace's lifetime
+    size_t allocated() const { return allocatedBytes; }
+    
+    // Cache-line aligned; mark receives what release() needs
+    void* acquire(size_t bytes, Mark& mark) {
+        mark = {current, offset};
+        live++;
+        if (bytes == 0) return nullptr;
+        
+        offset = (offset + CACHE_LINE_BYTES - 1) / CACHE_LINE_BYTES * CACHE_LINE_BYTES;
+        if (blocks.empty() || offset + bytes > blocks[current].size) {
+            // Move on to the next block big enough, allocating one if needed
+            size_t next = blocks.empty() ? 0 : current + 1;
+            while (next < blocks.size() && blocks[next].size < bytes) next++;
+            if (next == blocks.size()) {
+                size_t grown = blocks.empty() ? 0 : 2 * blocks.back().size;
+                blocks.push_back(allocateBlock(max({bytes, grown, MIN_BLOCK_BYTES})));
+            }
+            current = next;
+            offset = 0;
+        }
+        
+        void* data = blocks[current].data + offset;
+        offset += bytes;
+        return data;
+    }
+    
+    void release(const Mark& mark) {
+        current = mark.block;
+        offset = mark.offset;
+        
+        if (--live > 0) return;
+        
+        size_t total = capacity();
+        if (total > retainLimit()) {
+            // Over the limit: keep the leading (smaller) blocks that fit
+            size_t kept = 0, count = 0;
+            while (count < blocks.size() && kept + blocks[count].size <= retainLimit())
+                kept += blocks[count++].size;
+            for (size_t b = count; b < blocks.size(); b++)
+                freeBlock(blocks[b]);
+            blocks.resize(count);
+        } else if (blocks.size() > 1) {
+            // Idle again after growing: merge the blocks into one that fits it all
+            trim();
+            blocks.push_back(allocateBlock(total));
+        }
+    }
+    
+    // Frees every block; only while no ScratchBuffer is alive
+    void trim() {
+        for (Block& b : blocks) freeBlock(b);
+        blocks.clear();
+        current = offset = 0;
+    }
+
+private:
+    struct Block {
+        char* data;
+        size_t size;
+        void* allocation;
+        size_t mappedBytes; // Nonzero for huge-page mappings
+    };
+    
+    vector<Block> blocks;
+    size_t current = 0, offset = 0;
+    size_t live = 0; // Arrays acquired and not yet released
+    size_t allocatedBytes = 0;
+    bool hugePages;
+    
+    static atomic<size_t>& retainLimit() {
+        static atomic<size_t> limit{DEFAULT_RETAIN_BYTES};
+        return limit;
+    }
+    
+    Block allocateBlock(size_t bytes) {
+        allocatedBytes += bytes;
+#ifdef __linux__
+        if (hugePages) {
+            // Map a huge page extra to start on a huge-page boundary
+            size_t mapped = (bytes + 2 * HUGE_PAGE_BYTES - 1) / HUGE_PAGE_BYTES * HUGE_PAGE_BYTES;
+            void* map = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (map != MAP_FAILED) {
+                uintptr_t start = ((uintptr_t)map + HUGE_PAGE_BYTES - 1) / HUGE_PAGE_BYTES * HUGE_PAGE_BYTES;
+                madvise((void*)start, mapped - (start - (uintptr_t)map), MADV_HUGEPAGE);
+                return {(char*)start, mapped - (start - (uintptr_t)map), map, mapped};
+            }
+        }
+#endif
+        char* allocation = (char*)::operator new(bytes + CACHE_LINE_BYTES);
+        uintptr_t start = ((uintptr_t)allocation + CACHE_LINE_BYTES - 1) / CACHE_LINE_BYTES * CACHE_LINE_BYTES;
+        return {(char*)start, bytes, allocation, 0};
+    }
+    
+    static void freeBlock(Block& b) {
+#ifdef __linux__
+        if (b.mappedBytes) {
+            munmap(b.allocation, b.mappedBytes);
+            return;
+        }
+#endif
+        ::operator delete(b.allocation);
+    }
+};
+
+// Array of count T from a workspace, for the lifetime of the scope that
+// declares it. Use like a fixed-size vector; not copyable or movable.
+template <typename T>
+class ScratchBuffer {
+public:
+    // Default-initialized: ints and floats are left as they are, not zeroed
+    explicit ScratchBuffer(size_t count, SortWorkspace& workspace = SortWorkspace::local())
+        : workspace(workspace), count(count) {
+        items = (T*)workspace.acquire(count * sizeof(T), mark);
+        uninitialized_default_construct_n(items, count);
+    }
+    
+    ScratchBuffer(size_t count, const T& value, SortWorkspace& workspace = SortWorkspace::local())
+        : workspace(workspace), count(count) {
+        items = (T*)workspace.acquire(count * sizeof(T), mark);
+        uninitialized_fill_n(items, count, value);
+    }
+    
+    // Copy of [first, last)
+    template <typename InputIt, typename = typename iterator_traits<InputIt>::iterator_category>
+    ScratchBuffer(InputIt first, InputIt last, SortWorkspace& workspace = SortWorkspace::local())
+        : workspace(workspace), count(distance(first, last)) {
+        items = (T*)workspace.acquire(count * sizeof(T), mark);
+        uninitialized_copy(first, last, items);
+    }
+    
+    ScratchBuffer(const ScratchBuffer&) = delete;
+    ScratchBuffer& operator=(const ScratchBuffer&) = delete;
+    
+    ~ScratchBuffer() {
+        destroy_n(items, count);
+        workspace.release(mark);
+    }
+    
+    T* data() { return items; }
+    const T* data() const { return items; }
+    size_t size() const { return count; }
+    T& operator[](size_t i) { return items[i]; }
+    const T& operator[](size_t i) const { return items[i]; }
+    T* begin() { return items; }
+    T* end() { return items + count; }
+    const T* begin() const { return items; }
+    const T* end() const { return items + count; }
+
+private:
+    SortWorkspace& workspace;
+    SortWorkspace::Mark mark;
+    size_t count;
+    T* items;
+};
+
 // ==========================================================================
 // 1. BUBBLE SORT - O(n²) Time, O(1) Space
 // Simple comparison-based algorithm, good for educational purposes
 // ==========================================================================
 
-void bubbleSort(vector<int>& arr) {
+template <typename Stats = NullStats>
+void bubbleSort(vector<int>& arr, Stats&& stats = Stats()) {
     int n = arr.size();
     
     for (int i = 0; i < n - 1; i++) {
@@ -27,8 +447,10 @@ void bubbleSort(vector<int>& arr) {
         
         // Last i elements are already sorted
         for (int j = 0; j < n - i - 1; j++) {
+            stats.comparison();
             if (arr[j] > arr[j + 1]) {
                 swap(arr[j], arr[j + 1]);
+                stats.swap();
                 swapped = true;
             }
         }
@@ -43,7 +465,8 @@ void bubbleSort(vector<int>& arr) {
 // Finds minimum element and places it at the beginning
 // ==========================================================================
 
-void selectionSort(vector<int>& arr) {
+template <typename Stats = NullStats>
+void selectionSort(vector<int>& arr, Stats&& stats = Stats()) {
     int n = arr.size();
     
     for (int i = 0; i < n - 1; i++) {
@@ -51,6 +474,7 @@ void selectionSort(vector<int>& arr) {
         
         // Find the minimum element in remaining array
         for (int j = i + 1; j < n; j++) {
+            stats.comparison();
             if (arr[j] < arr[minIndex]) {
                 minIndex = j;
             }
@@ -59,6 +483,7 @@ void selectionSort(vector<int>& arr) {
         // Swap the found minimum element with first element
         if (minIndex != i) {
             swap(arr[i], arr[minIndex]);
+            stats.swap();
         }
     }
 }
@@ -68,34 +493,57 @@ void selectionSort(vector<int>& arr) {
 // Builds sorted array one element at a time, good for small arrays
 // ==========================================================================
 
-void insertionSort(vector<int>& arr) {
-    int n = arr.size();
-    
-    for (int i = 1; i < n; i++) {
+// Sorts arr[low..high] in place
+template <typename Stats = NullStats>
+void insertionSortRange(vector<int>& arr, int low, int high, Stats&& stats = Stats()) {
+    for (int i = low + 1; i <= high; i++) {
         int key = arr[i];
         int j = i - 1;
         
         // Move elements greater than key one position ahead
-        while (j >= 0 && arr[j] > key) {
+        while (j >= low && (stats.comparison(), arr[j] > key)) {
             arr[j + 1] = arr[j];
+            stats.move();
             j--;
         }
         
         arr[j + 1] = key;
+        stats.move();
     }
 }
 
+template <typename Stats = NullStats>
+void insertionSort(vector<int>& arr, Stats&& stats = Stats()) {
+    insertionSortRange(arr, 0, arr.size() - 1, stats);
+}
+
+// Leaf case of the recursive sorts. The network's compare-exchanges run in
+// vector registers where they cannot be counted, so instrumented calls sort
+// their leaves by insertion sort instead.
+template <typename Stats>
+void sortLeaf(vector<int>& arr, int low, int high, Stats& stats) {
+    if constexpr (decay_t<Stats>::enabled)
+        insertionSortRange(arr, low, high, stats);
+    else
+        sortSmallBlock(&arr[low], high - low + 1);
+}
+
 // ==========================================================================
 // 4. MERGE SORT - O(n log n) Time, O(n) Space
 // Divide and conquer algorithm, stable sorting
 // ==========================================================================
 
-void merge(vector<int>& arr, int left, int mid, int right) {
+template <typename Stats = NullStats>
+void merge(vector<int>& arr, int left, int mid, int right, Stats&& stats = Stats()) {
     int n1 = mid - left + 1;
     int n2 = right - mid;
     
-    // Create temporary arrays
-    vector<int> leftArr(n1), rightArr(n2);
+    // Create temporary arrays; only workspace growth reaches the heap
+    size_t allocatedBefore = 0;
+    if constexpr (decay_t<Stats>::enabled) allocatedBefore = SortWorkspace::local().allocated();
+    ScratchBuffer<int> leftArr(n1), rightArr(n2);
+    if constexpr (decay_t<Stats>::enabled) stats.allocation(SortWorkspace::local().allocated() - allocatedBefore);
+    stats.move(n1 + n2);
     
     // Copy data to temporary arrays
     for (int i = 0; i < n1; i++)
@@ -107,6 +555,7 @@ void merge(vector<int>& arr, int left, int mid, int right) {
     int i = 0, j = 0, k = left;
     
     while (i < n1 && j < n2) {
+        stats.comparison();
         if (leftArr[i] <= rightArr[j]) {
             arr[k] = leftArr[i];
             i++;
@@ -117,6 +566,9 @@ void merge(vector<int>& arr, int left, int mid, int right) {
         k++;
     }
     
+    // Every element is written back once
+    stats.move(n1 + n2);
+    
     // Copy remaining elements
     while (i < n1) {
         arr[k] = leftArr[i];
@@ -131,18 +583,26 @@ void merge(vector<int>& arr, int left, int mid, int right) {
     }
 }
 
-void mergeSortHelper(vector<int>& arr, int left, int right) {
+template <typename Stats = NullStats>
+void mergeSortHelper(vector<int>& arr, int left, int right, Stats&& stats = Stats()) {
     if (left < right) {
+        // Small ranges: sorting network instead of recursing further
+        if (right - left < SORTING_NETWORK_MAX) {
+            sortLeaf(arr, left, right, stats);
+            return;
+        }
+        
         int mid = left + (right - left) / 2;
         
-        mergeSortHelper(arr, left, mid);
-        mergeSortHelper(arr, mid + 1, right);
-        merge(arr, left, mid, right);
+        mergeSortHelper(arr, left, mid, stats);
+        mergeSortHelper(arr, mid + 1, right, stats);
+        merge(arr, left, mid, right, stats);
     }
 }
 
-void mergeSort(vector<int>& arr) {
-    mergeSortHelper(arr, 0, arr.size() - 1);
+template <typename Stats = NullStats>
+void mergeSort(vector<int>& arr, Stats&& stats = Stats()) {
+    mergeSortHelper(arr, 0, arr.size() - 1, stats);
 }
 
 // ==========================================================================
@@ -152,129 +612,258 @@ void mergeSort(vector<int>& arr) {
 // ==========================================================================
 
 // 5A. STANDARD QUICK SORT (Last element as pivot)
-int partition(vector<int>& arr, int low, int high) {
+template <typename Stats = NullStats>
+int partition(vector<int>& arr, int low, int high, Stats&& stats = Stats()) {
     int pivot = arr[high]; // Choose last element as pivot
     int i = low - 1; // Index of smaller element
     
     for (int j = low; j < high; j++) {
         // If current element is smaller than or equal to pivot
+        stats.comparison();
         if (arr[j] <= pivot) {
             i++;
             swap(arr[i], arr[j]);
+            stats.swap();
         }
     }
     
     swap(arr[i + 1], arr[high]);
+    stats.swap();
     return i + 1;
 }
 
-void quickSortHelper(vector<int>& arr, int low, int high) {
+// Block partition (BlockQuicksort): instead of branching on every
+// comparison, scan a block from each end and record the offsets of the
+// elements that must cross, using the comparison result as an integer,
+// then swap the recorded pairs in one batch. Misses only happen on the
+// loop edges, not on the data.
+const int PARTITION_BLOCK = 128; // Offsets fit in a byte
+
+// Splits arr[low..high] into a left part whose elements leftKeeps accepts
+// or rightKeeps rejects, and a right part with the opposite property;
+// returns where the right part starts. With complementary predicates this
+// is a plain two-way split; with x < p and p < x, keys equal to p may end
+// up on either side, which keeps runs of duplicates balanced.
+template <typename LeftKeeps, typename RightKeeps, typename Stats>
+int blockPartitionBy(vector<int>& arr, int low, int high, LeftKeeps leftKeeps, RightKeeps rightKeeps,
+                     Stats& stats) {
+    uint8_t offsetsLeft[PARTITION_BLOCK], offsetsRight[PARTITION_BLOCK];
+    int startLeft = 0, countLeft = 0, startRight = 0, countRight = 0;
+    int l = low, r = high;
+    
+    // Left block arr[l .. l + B - 1], right block arr[r - B + 1 .. r]
+    while (r - l + 1 > 2 * PARTITION_BLOCK) {
+        if (countLeft == 0) {
+            startLeft = 0;
+            for (int i = 0; i < PARTITION_BLOCK; i++) {
+                offsetsLeft[countLeft] = i;
+                countLeft += !leftKeeps(arr[l + i]);
+            }
+            stats.comparison(PARTITION_BLOCK);
+        }
+        
+        if (countRight == 0) {
+            startRight = 0;
+            for (int i = 0; i < PARTITION_BLOCK; i++) {
+                offsetsRight[countRight] = i;
+                countRight += !rightKeeps(arr[r - i]);
+            }
+            stats.comparison(PARTITION_BLOCK);
+        }
+        
+        int pairs = min(countLeft, countRight);
+        for (int i = 0; i < pairs; i++)
+            swap(arr[l + offsetsLeft[startLeft + i]], arr[r - offsetsRight[startRight + i]]);
+        stats.swap(pairs);
+        
+        countLeft -= pairs;
+        countRight -= pairs;
+        startLeft += pairs;
+        startRight += pairs;
+        
+        // A block is done once all its misplaced elements have crossed
+        if (countLeft == 0) l += PARTITION_BLOCK;
+        if (countRight == 0) r -= PARTITION_BLOCK;
+    }
+    
+    // At most two blocks left: finish with a classic Hoare scan. Elements
+    // of a half-done block that already crossed are simply passed over.
+    while (true) {
+        while (l <= r && (stats.comparison(), leftKeeps(arr[l]))) l++;
+        while (l <= r && (stats.comparison(), rightKeeps(arr[r]))) r--;
+        if (l >= r) break;
+        
+        swap(arr[l++], arr[r--]);
+        stats.swap();
+    }
+    
+    return l;
+}
+
+// Same contract as partition (pivot arr[high], returns its final index)
+template <typename Stats = NullStats>
+int blockPartition(vector<int>& arr, int low, int high, Stats&& stats = Stats()) {
+    int pivot = arr[high];
+    int boundary = blockPartitionBy(
+        arr, low, high - 1, [pivot](int x) { return x < pivot; }, [pivot](int x) { return pivot < x; }, stats);
+    
+    swap(arr[boundary], arr[high]);
+    stats.swap();
+    return boundary;
+}
+
+template <typename Stats = NullStats>
+void quickSortHelper(vector<int>& arr, int low, int high, Stats&& stats = Stats()) {
     if (low < high) {
-        int pi = partition(arr, low, high);
+        // Small ranges: sorting network instead of recursing further
+        if (high - low < SORTING_NETWORK_MAX) {
+            sortLeaf(arr, low, high, stats);
+            return;
+        }
         
-        quickSortHelper(arr, low, pi - 1);
-        quickSortHelper(arr, pi + 1, high);
+        int pi = blockPartition(arr, low, high, stats);
+        
+        quickSortHelper(arr, low, pi - 1, stats);
+        quickSortHelper(arr, pi + 1, high, stats);
     }
 }
 
-void quickSort(vector<int>& arr) {
-    quickSortHelper(arr, 0, arr.size() - 1);
+template <typename Stats = NullStats>
+void quickSort(vector<int>& arr, Stats&& stats = Stats()) {
+    quickSortHelper(arr, 0, arr.size() - 1, stats);
 }
 
 // 5B. QUICK SORT WITH RANDOM PIVOT (Better average performance)
-int partitionRandom(vector<int>& arr, int low, int high) {
+template <typename Stats = NullStats>
+int partitionRandom(vector<int>& arr, int low, int high, Stats&& stats = Stats()) {
     // Generate random index between low and high
     int randomIndex = low + rand() % (high - low + 1);
     swap(arr[randomIndex], arr[high]); // Move random element to end
+    stats.swap();
     
-    return partition(arr, low, high); // Use standard partition
+    return partition(arr, low, high, stats); // Use standard partition
 }
 
-void quickSortRandomHelper(vector<int>& arr, int low, int high) {
+template <typename Stats = NullStats>
+void quickSortRandomHelper(vector<int>& arr, int low, int high, Stats&& stats = Stats()) {
     if (low < high) {
-        int pi = partitionRandom(arr, low, high);
+        int pi = partitionRandom(arr, low, high, stats);
         
-        quickSortRandomHelper(arr, low, pi - 1);
-        quickSortRandomHelper(arr, pi + 1, high);
+        quickSortRandomHelper(arr, low, pi - 1, stats);
+        quickSortRandomHelper(arr, pi + 1, high, stats);
     }
 }
 
-void quickSortRandom(vector<int>& arr) {
+template <typename Stats = NullStats>
+void quickSortRandom(vector<int>& arr, Stats&& stats = Stats()) {
     srand(time(nullptr)); // Initialize random seed
-    quickSortRandomHelper(arr, 0, arr.size() - 1);
+    quickSortRandomHelper(arr, 0, arr.size() - 1, stats);
 }
 
 // 5C. QUICK SORT WITH MEDIAN-OF-THREE PIVOT (Improved worst-case)
-int medianOfThree(vector<int>& arr, int low, int high) {
+// Orders arr[a] <= arr[b] <= arr[c]
+template <typename Stats = NullStats>
+void sort3(vector<int>& arr, int a, int b, int c, Stats&& stats = Stats()) {
+    stats.comparison(3);
+    if (arr[b] < arr[a]) {
+        swap(arr[b], arr[a]);
+        stats.swap();
+    }
+    if (arr[c] < arr[a]) {
+        swap(arr[c], arr[a]);
+        stats.swap();
+    }
+    if (arr[c] < arr[b]) {
+        swap(arr[c], arr[b]);
+        stats.swap();
+    }
+}
+
+template <typename Stats = NullStats>
+int medianOfThree(vector<int>& arr, int low, int high, Stats&& stats = Stats()) {
     int mid = low + (high - low) / 2;
     
-    if (arr[mid] < arr[low])
-        swap(arr[mid], arr[low]);
-    if (arr[high] < arr[low])
-        swap(arr[high], arr[low]);
-    if (arr[high] < arr[mid])
-        swap(arr[high], arr[mid]);
+    sort3(arr, low, mid, high, stats);
     
     return mid;
 }
 
-int partitionMedian(vector<int>& arr, int low, int high) {
-    int medianIndex = medianOfThree(arr, low, high);
+template <typename Stats = NullStats>
+int partitionMedian(vector<int>& arr, int low, int high, Stats&& stats = Stats()) {
+    int medianIndex = medianOfThree(arr, low, high, stats);
     swap(arr[medianIndex], arr[high]); // Move median to end
+    stats.swap();
     
-    return partition(arr, low, high);
+    return blockPartition(arr, low, high, stats);
 }
 
-void quickSortMedianHelper(vector<int>& arr, int low, int high) {
+template <typename Stats = NullStats>
+void quickSortMedianHelper(vector<int>& arr, int low, int high, Stats&& stats = Stats()) {
     if (low < high) {
-        int pi = partitionMedian(arr, low, high);
+        int pi = partitionMedian(arr, low, high, stats);
         
-        quickSortMedianHelper(arr, low, pi - 1);
-        quickSortMedianHelper(arr, pi + 1, high);
+        quickSortMedianHelper(arr, low, pi - 1, stats);
+        quickSortMedianHelper(arr, pi + 1, high, stats);
     }
 }
 
-void quickSortMedian(vector<int>& arr) {
-    quickSortMedianHelper(arr, 0, arr.size() - 1);
+template <typename Stats = NullStats>
+void quickSortMedian(vector<int>& arr, Stats&& stats = Stats()) {
+    quickSortMedianHelper(arr, 0, arr.size() - 1, stats);
 }
 
 // 5D. ITERATIVE QUICK SORT (No recursion - uses stack)
-void quickSortIterative(vector<int>& arr) {
+template <typename Stats = NullStats>
+void quickSortIterative(vector<int>& arr, Stats&& stats = Stats()) {
     if (arr.size() <= 1) return;
     
-    // Create auxiliary stack
-    stack<pair<int, int>> st;
-    st.push({0, (int)arr.size() - 1});
+    // Create auxiliary stack. Taking the smaller side first bounds it by
+    // log2(n) + 1 entries, so it is a fixed array.
+    int capacity = 2;
+    for (size_t n = arr.size(); n > 1; n >>= 1) capacity++;
+    ScratchBuffer<pair<int, int>> st(capacity);
+    int top = 0;
+    st[top++] = {0, (int)arr.size() - 1};
     
-    while (!st.empty()) {
-        int high = st.top().second;
-        int low = st.top().first;
-        st.pop();
+    while (top > 0) {
+        int high = st[top - 1].second;
+        int low = st[top - 1].first;
+        top--;
         
         if (low < high) {
-            int pi = partition(arr, low, high);
+            int pi = partition(arr, low, high, stats);
             
-            // Push left and right subarrays
-            st.push({low, pi - 1});
-            st.push({pi + 1, high});
+            // Push the larger side first so the smaller one is taken next;
+            // the stack then never holds more than O(log n) ranges
+            if (pi - low > high - pi) {
+                st[top++] = {low, pi - 1};
+                st[top++] = {pi + 1, high};
+            } else {
+                st[top++] = {pi + 1, high};
+                st[top++] = {low, pi - 1};
+            }
         }
     }
 }
 
 // 5E. THREE-WAY QUICK SORT (Handles duplicates efficiently)
-void threeWayPartition(vector<int>& arr, int low, int high, int& lt, int& gt) {
+template <typename Stats = NullStats>
+void threeWayPartition(vector<int>& arr, int low, int high, int& lt, int& gt, Stats&& stats = Stats()) {
     int pivot = arr[low];
     int i = low + 1;
     lt = low;
     gt = high;
     
     while (i <= gt) {
+        stats.comparison();
         if (arr[i] < pivot) {
             swap(arr[lt], arr[i]);
+            stats.swap();
             lt++;
             i++;
-        } else if (arr[i] > pivot) {
+        } else if (stats.comparison(), arr[i] > pivot) {
             swap(arr[i], arr[gt]);
+            stats.swap();
             gt--;
         } else {
             i++;
@@ -282,271 +871,4524 @@ void threeWayPartition(vector<int>& arr, int low, int high, int& lt, int& gt) {
     }
 }
 
-void quickSort3WayHelper(vector<int>& arr, int low, int high) {
+// Same contract as threeWayPartition, in two branch-free block passes:
+// keys below the pivot go left, then the rest splits into equal and greater
+template <typename Stats = NullStats>
+void threeWayBlockPartition(vector<int>& arr, int low, int high, int& lt, int& gt, Stats&& stats = Stats()) {
+    int pivot = arr[low];
+    auto below = [pivot](int x) { return x < pivot; };
+    auto above = [pivot](int x) { return pivot < x; };
+    
+    lt = blockPartitionBy(arr, low, high, below, [&](int x) { return !below(x); }, stats);
+    gt = blockPartitionBy(arr, lt, high, [&](int x) { return !above(x); }, above, stats) - 1;
+}
+
+template <typename Stats = NullStats>
+void quickSort3WayHelper(vector<int>& arr, int low, int high, Stats&& stats = Stats()) {
     if (low >= high) return;
     
+    // Small ranges: sorting network instead of recursing further
+    if (high - low < SORTING_NETWORK_MAX) {
+        sortLeaf(arr, low, high, stats);
+        return;
+    }
+    
     int lt, gt;
-    threeWayPartition(arr, low, high, lt, gt);
+    threeWayBlockPartition(arr, low, high, lt, gt, stats);
     
-    quickSort3WayHelper(arr, low, lt - 1);
-    quickSort3WayHelper(arr, gt + 1, high);
+    quickSort3WayHelper(arr, low, lt - 1, stats);
+    quickSort3WayHelper(arr, gt + 1, high, stats);
 }
 
-void quickSort3Way(vector<int>& arr) {
-    quickSort3WayHelper(arr, 0, arr.size() - 1);
+template <typename Stats = NullStats>
+void quickSort3Way(vector<int>& arr, Stats&& stats = Stats()) {
+    quickSort3WayHelper(arr, 0, arr.size() - 1, stats);
 }
 
-// ==========================================================================
-// 6. HEAP SORT - O(n log n) Time, O(1) Space
-// Uses binary heap data structure, not stable
-// ==========================================================================
+// 5F. PARALLEL QUICK SORT (Work-stealing, the iterative version's stack
+// becomes the pool's per-thread deques)
+// Ranges of several cutoffs are partitioned by all threads at once, so the
+// first O(n) passes do not run on one core; after each split the larger
+// side is handed to the pool and the smaller one kept, and ranges below
+// PARALLEL_SORT_CUTOFF finish with pattern-defeating quick sort.
 
-void heapify(vector<int>& arr, int n, int i) {
-    int largest = i; // Initialize largest as root
-    int left = 2 * i + 1;
-    int right = 2 * i + 2;
+// Same contract as blockPartition, around a ninther pivot. Large ranges are
+// cut into chunks that are block-partitioned concurrently; the elements on
+// the wrong side of the combined boundary are then swapped across it in
+// parallel slices.
+int parallelPartition(vector<int>& arr, int low, int high) {
+    int size = high - low + 1;
+    int mid = low + size / 2;
+    sort3(arr, low, mid, high);
+    sort3(arr, low + 1, mid - 1, high - 1);
+    sort3(arr, low + 2, mid + 1, high - 2);
+    sort3(arr, mid - 1, mid, mid + 1);
+    swap(arr[mid], arr[high]);
+    
+    int chunks = min(sortThreadCount(), size / PARALLEL_SORT_CUTOFF);
+    if (chunks <= 1) return blockPartition(arr, low, high);
+    
+    int pivot = arr[high];
+    int count = size - 1;
+    auto chunkStart = [&](int c) { return low + (int)((long long)count * c / chunks); };
     
-    // If left child is larger than root
-    if (left < n && arr[left] > arr[largest])
-        largest = left;
+    ScratchBuffer<int> boundary(chunks);
+    runParallel(chunks, [&](int c) {
+        NullStats stats;
+        boundary[c] = blockPartitionBy(
+            arr, chunkStart(c), chunkStart(c + 1) - 1, [pivot](int x) { return x < pivot; },
+            [pivot](int x) { return pivot < x; }, stats);
+    });
     
-    // If right child is larger than largest so far
-    if (right < n && arr[right] > arr[largest])
-        largest = right;
+    // Right-side elements before split and left-side elements from split on
+    int split = low;
+    for (int c = 0; c < chunks; c++)
+        split += boundary[c] - chunkStart(c);
     
-    // If largest is not root
-    if (largest != i) {
-        swap(arr[i], arr[largest]);
-        heapify(arr, n, largest);
+    vector<pair<int, int>> wrongLeft, wrongRight;
+    long long misplaced = 0;
+    for (int c = 0; c < chunks; c++) {
+        int leftEnd = min(chunkStart(c + 1), split), rightStart = max(chunkStart(c), split);
+        if (boundary[c] < leftEnd) {
+            wrongLeft.push_back({boundary[c], leftEnd});
+            misplaced += leftEnd - boundary[c];
+        }
+        if (rightStart < boundary[c]) wrongRight.push_back({rightStart, boundary[c]});
+    }
+    
+    // Slice c swaps the misplaced pairs of rank [first, last)
+    runParallel(chunks, [&](int c) {
+        long long first = misplaced * c / chunks, last = misplaced * (c + 1) / chunks;
+        
+        auto seek = [](const vector<pair<int, int>>& spans, long long rank, size_t& span) {
+            for (span = 0; rank >= spans[span].second - spans[span].first; span++)
+                rank -= spans[span].second - spans[span].first;
+            return spans[span].first + (int)rank;
+        };
+        
+        if (first == last) return;
+        size_t leftSpan, rightSpan;
+        int i = seek(wrongLeft, first, leftSpan);
+        int j = seek(wrongRight, first, rightSpan);
+        
+        for (long long rank = first; rank < last; rank++) {
+            if (i == wrongLeft[leftSpan].second) i = wrongLeft[++leftSpan].first;
+            if (j == wrongRight[rightSpan].second) j = wrongRight[++rightSpan].first;
+            swap(arr[i++], arr[j++]);
+        }
+    });
+    
+    swap(arr[split], arr[high]);
+    return split;
+}
+
+void parallelQuickSortTask(vector<int>& arr, int low, int high, int badAllowed,
+                           WorkStealingPool::TaskGroup& group) {
+    while (high - low + 1 >= PARALLEL_SORT_CUTOFF) {
+        int size = high - low + 1;
+        int pivotPos = parallelPartition(arr, low, high);
+        int leftSize = pivotPos - low;
+        int rightSize = high - pivotPos;
+        
+        // Adversarial pivots: let pdq sort (heap sort fallback) take over
+        if ((leftSize < size / 8 || rightSize < size / 8) && --badAllowed == 0) break;
+        
+        auto spawn = [&](int taskLow, int taskHigh) {
+            WorkStealingPool::instance().submit(group, [&arr, taskLow, taskHigh, badAllowed, &group] {
+                parallelQuickSortTask(arr, taskLow, taskHigh, badAllowed, group);
+            });
+        };
+        
+        if (leftSize > rightSize) {
+            spawn(low, pivotPos - 1);
+            low = pivotPos + 1;
+        } else {
+            spawn(pivotPos + 1, high);
+            high = pivotPos - 1;
+        }
     }
+    
+    pdqSortRange(arr, low, high);
 }
 
-void heapSort(vector<int>& arr) {
+void parallelQuickSort(vector<int>& arr) {
     int n = arr.size();
+    if (n < PARALLEL_SORT_CUTOFF || sortThreadCount() == 1) {
+        pdqSortRange(arr, 0, n - 1);
+        return;
+    }
     
-    // Build heap (rearrange array)
-    for (int i = n / 2 - 1; i >= 0; i--)
-        heapify(arr, n, i);
+    int badAllowed = 1;
+    while (n >>= 1) badAllowed++;
     
-    // Extract elements from heap one by one
-    for (int i = n - 1; i > 0; i--) {
-        swap(arr[0], arr[i]); // Move current root to end
-        heapify(arr, i, 0); // Call heapify on reduced heap
-    }
+    WorkStealingPool::TaskGroup group;
+    parallelQuickSortTask(arr, 0, arr.size() - 1, badAllowed, group);
+    WorkStealingPool::instance().wait(group);
 }
 
 // ==========================================================================
-// 7. COUNTING SORT - O(n + k) Time, O(k) Space
-// Non-comparison based, works when range of elements is known
+// 6. HEAP SORT - O(n log n) Time, O(1) Space
+// d-ary max-heap (4 or 8 children per node, side by side in memory)
+// with Floyd's bottom-up sift: the hole at the root walks down to a leaf
+// along the larger child, then the displaced value climbs back up, which
+// is rarely more than a level. The root's Arity - 1 children share its
+// group and node i >= 1 has children Arity*i .. Arity*i + Arity - 1, so
+// every group of siblings starts at a multiple of Arity. Heap sort starts
+// the heap on a group-aligned address and inserts the few elements before
+// it at the end, so each level reads one cache line; the grandchildren
+// are prefetched a level ahead. Not stable.
 // ==========================================================================
 
-void countingSort(vector<int>& arr) {
-    if (arr.empty()) return;
-    
-    // Find the maximum element to determine range
-    int maxElement = *max_element(arr.begin(), arr.end());
-    int minElement = *min_element(arr.begin(), arr.end());
-    int range = maxElement - minElement + 1;
-    
-    // Create count array
-    vector<int> count(range, 0);
-    vector<int> output(arr.size());
-    
-    // Store count of each element
-    for (int i = 0; i < arr.size(); i++)
-        count[arr[i] - minElement]++;
+// Children per node: 8 for ints and smaller, 4 for anything wider
+template <typename T>
+constexpr int heapArity = sizeof(T) <= sizeof(int) ? 8 : 4;
+
+// First child of node; every node's children end at Arity * node + Arity
+template <int Arity>
+constexpr ptrdiff_t daryFirstChild(ptrdiff_t node) {
+    return node == 0 ? 1 : Arity * node;
+}
+
+// Moves value up from heap[hole] towards heap[top] until its parent is not
+// smaller, then stores it
+template <int Arity, typename RandomIt, typename T, typename Before, typename Stats>
+void daryHeapPlace(RandomIt heap, ptrdiff_t top, ptrdiff_t hole, T&& value, Before& before, Stats& stats) {
+    while (hole > top) {
+        ptrdiff_t parent = hole / Arity;
+        stats.comparison();
+        if (!before(heap[parent], value)) break;
+        
+        heap[hole] = std::move(heap[parent]);
+        stats.move();
+        hole = parent;
+    }
     
-    // Change count[i] to actual position
-    for (int i = 1; i < range; i++)
-        count[i] += count[i - 1];
+    heap[hole] = std::move(value);
+    stats.move();
+}
+
+// Fills heap[hole] with value in the heap heap[0 .. n - 1], whose subtrees
+// below hole are already heaps
+template <int Arity, typename RandomIt, typename T, typename Before, typename Stats>
+void daryHeapFillHole(RandomIt heap, ptrdiff_t n, ptrdiff_t hole, T&& value, Before& before, Stats& stats) {
+    static_assert(Arity >= 2 && (Arity & (Arity - 1)) == 0, "heap arity must be a power of two");
+    typedef typename iterator_traits<RandomIt>::value_type Element;
+    const ptrdiff_t lineStep = max<ptrdiff_t>(1, CACHE_LINE_BYTES / sizeof(Element));
+    ptrdiff_t top = hole;
     
-    // Build output array
-    for (int i = arr.size() - 1; i >= 0; i--) {
-        output[count[arr[i] - minElement] - 1] = arr[i];
-        count[arr[i] - minElement]--;
+    // Descend to a leaf, promoting the largest child at each level
+    while (true) {
+        ptrdiff_t child = daryFirstChild<Arity>(hole);
+        if (child >= n) break;
+        
+        ptrdiff_t childEnd = min(Arity * hole + Arity, n);
+        ptrdiff_t grandchildrenEnd = min(Arity * childEnd, n);
+        for (ptrdiff_t g = Arity * child; g < grandchildrenEnd; g += lineStep)
+            __builtin_prefetch(&heap[g]);
+        
+        // Full nodes pick the largest child by a knockout between pairs, so
+        // the comparisons of one round do not wait on each other
+        ptrdiff_t childCount = childEnd - child;
+        ptrdiff_t largest = child;
+        if (childCount == Arity) {
+            ptrdiff_t best[Arity];
+            for (int c = 0; c < Arity; c++) best[c] = child + c;
+            
+            for (int width = Arity / 2; width > 0; width /= 2)
+                for (int c = 0; c < width; c++) {
+                    stats.comparison();
+                    best[c] = before(heap[best[c]], heap[best[c + width]]) ? best[c + width] : best[c];
+                }
+            
+            largest = best[0];
+        } else {
+            for (ptrdiff_t c = 1; c < childCount; c++) {
+                stats.comparison();
+                largest = before(heap[largest], heap[child + c]) ? child + c : largest;
+            }
+        }
+        
+        heap[hole] = std::move(heap[largest]);
+        stats.move();
+        hole = largest;
     }
     
-    // Copy output array to original array
-    for (int i = 0; i < arr.size(); i++)
-        arr[i] = output[i];
+    daryHeapPlace<Arity>(heap, top, hole, std::move(value), before, stats);
 }
 
-// ==========================================================================
-// 8. RADIX SORT - O(d * (n + k)) Time, O(n + k) Space
-// Non-comparison based, sorts by individual digits
-// ==========================================================================
-
-int getMax(vector<int>& arr) {
-    return *max_element(arr.begin(), arr.end());
+template <int Arity, typename RandomIt, typename Before, typename Stats>
+void daryHeapMake(RandomIt heap, ptrdiff_t n, Before& before, Stats& stats) {
+    if (n < 2) return;
+    
+    for (ptrdiff_t i = (n - 1) / Arity; i >= 0; i--) {
+        auto value = std::move(heap[i]);
+        daryHeapFillHole<Arity>(heap, n, i, std::move(value), before, stats);
+    }
 }
 
-void countingSortForRadix(vector<int>& arr, int exp) {
-    int n = arr.size();
-    vector<int> output(n);
-    vector<int> count(10, 0);
+template <int Arity, typename RandomIt, typename Before, typename Stats>
+void daryHeapSort(RandomIt first, ptrdiff_t n, Before& before, Stats& stats) {
+    typedef typename iterator_traits<RandomIt>::value_type Element;
     
-    // Store count of occurrences
-    for (int i = 0; i < n; i++)
-        count[(arr[i] / exp) % 10]++;
+    // Elements before the first group-aligned address stay out of the heap
+    ptrdiff_t skip = 0;
+    if constexpr (is_pointer_v<RandomIt>) {
+        const size_t groupBytes = Arity * sizeof(Element);
+        size_t misalignment = (groupBytes - (uintptr_t)first % groupBytes) % groupBytes;
+        if (CACHE_LINE_BYTES % groupBytes == 0 && misalignment % sizeof(Element) == 0)
+            skip = min<ptrdiff_t>(n, misalignment / sizeof(Element));
+    }
     
-    // Change count[i] to actual position
-    for (int i = 1; i < 10; i++)
-        count[i] += count[i - 1];
+    RandomIt heap = first + skip;
+    ptrdiff_t size = n - skip;
+    daryHeapMake<Arity>(heap, size, before, stats);
     
-    // Build output array
-    for (int i = n - 1; i >= 0; i--) {
-        output[count[(arr[i] / exp) % 10] - 1] = arr[i];
-        count[(arr[i] / exp) % 10]--;
+    // Move the root behind the shrinking heap; the last element refills it
+    for (ptrdiff_t i = size - 1; i > 0; i--) {
+        auto value = std::move(heap[i]);
+        heap[i] = std::move(heap[0]);
+        stats.move();
+        daryHeapFillHole<Arity>(heap, i, 0, std::move(value), before, stats);
     }
     
-    // Copy output array to arr
-    for (int i = 0; i < n; i++)
-        arr[i] = output[i];
+    // Binary-insert the skipped elements into the sorted rest
+    for (ptrdiff_t i = skip - 1; i >= 0; i--) {
+        ptrdiff_t low = i + 1, high = n;
+        while (low < high) {
+            ptrdiff_t mid = low + (high - low) / 2;
+            stats.comparison();
+            if (before(first[i], first[mid]))
+                high = mid;
+            else
+                low = mid + 1;
+        }
+        
+        auto value = std::move(first[i]);
+        std::move(first + i + 1, first + low, first + i);
+        first[low - 1] = std::move(value);
+        stats.move(low - i);
+    }
 }
 
-void radixSort(vector<int>& arr) {
-    int maxNum = getMax(arr);
-    
-    // Do counting sort for every digit
-    for (int exp = 1; maxNum / exp > 0; exp *= 10)
-        countingSortForRadix(arr, exp);
+// Sorts arr[low..high] in place
+template <typename Stats = NullStats>
+void heapSortRange(vector<int>& arr, int low, int high, Stats&& stats = Stats()) {
+    auto before = [](int a, int b) { return a < b; };
+    daryHeapSort<heapArity<int>>(arr.data() + low, high - low + 1, before, stats);
 }
 
-// ==========================================================================
-// 9. BUCKET SORT - O(n + k) Average, O(n²) Worst, O(n + k) Space
-// Distributes elements into buckets and sorts individually
-// ==========================================================================
+template <typename Stats = NullStats>
+void heapSort(vector<int>& arr, Stats&& stats = Stats()) {
+    heapSortRange(arr, 0, arr.size() - 1, stats);
+}
 
-void bucketSort(vector<float>& arr) {
-    if (arr.empty()) return;
+// Priority queue on the same heap: top() is the largest element under
+// Compare, as with std::priority_queue
+template <typename T, int Arity = heapArity<T>, typename Compare = less<T>>
+class DaryHeap {
+public:
+    explicit DaryHeap(Compare comp = Compare()) : comp(comp) {}
     
-    int n = arr.size();
+    // Builds the heap from values in O(n)
+    explicit DaryHeap(vector<T> values, Compare comp = Compare()) : items(std::move(values)), comp(comp) {
+        NullStats stats;
+        daryHeapMake<Arity>(items.begin(), items.size(), this->comp, stats);
+    }
     
-    // Create n empty buckets
-    vector<vector<float>> buckets(n);
+    bool empty() const { return items.empty(); }
+    size_t size() const { return items.size(); }
+    const T& top() const { return items.front(); }
     
-    // Put array elements in different buckets
-    for (int i = 0; i < n; i++) {
-        int bucketIndex = n * arr[i]; // Assuming arr[i] is between 0 and 1
-        buckets[bucketIndex].push_back(arr[i]);
+    void reserve(size_t capacity) { items.reserve(capacity); }
+    void clear() { items.clear(); }
+    
+    void push(T value) {
+        NullStats stats;
+        items.push_back(std::move(value));
+        T added = std::move(items.back());
+        daryHeapPlace<Arity>(items.begin(), 0, items.size() - 1, std::move(added), comp, stats);
     }
     
-    // Sort individual buckets using insertion sort
-    for (int i = 0; i < n; i++) {
-        sort(buckets[i].begin(), buckets[i].end());
+    void pop() {
+        NullStats stats;
+        T last = std::move(items.back());
+        items.pop_back();
+        if (!items.empty())
+            daryHeapFillHole<Arity>(items.begin(), items.size(), 0, std::move(last), comp, stats);
     }
     
-    // Concatenate all buckets into arr[]
-    int index = 0;
-    for (int i = 0; i < n; i++) {
-        for (float value : buckets[i]) {
-            arr[index++] = value;
+    // pop() then push(value) in a single sift; a plain push when empty
+    void replaceTop(T value) {
+        if (items.empty()) {
+            push(std::move(value));
+            return;
         }
+        
+        NullStats stats;
+        daryHeapFillHole<Arity>(items.begin(), items.size(), 0, std::move(value), comp, stats);
     }
-}
+
+private:
+    vector<T> items;
+    Compare comp;
+};
 
 // ==========================================================================
-// 10. SHELL SORT - O(n log n) to O(n²) Time, O(1) Space
-// Improved insertion sort with gap sequence
+// 7. COUNTING SORT - O(n / p + p * k) Time, O(p * k) Space
+// Non-comparison based, works when range of elements is known; ranges too
+// wide for the histogram budget go to radix sort
 // ==========================================================================
 
-void shellSort(vector<int>& arr) {
-    int n = arr.size();
+const size_t COUNTING_SORT_BUDGET = 64 << 20; // Histogram bytes before falling back to radix sort
+const long long COUNTING_SUB_RANGE = 1 << 12; // Ranges up to this get interleaved sub-histograms
+const int COUNTING_SUB_HISTOGRAMS = 4;
+
+// countingSortKeys with Count as the counter type
+template <typename Count, typename Key>
+bool countingSortKeysWith(Key* data, size_t n) {
+    auto [minIt, maxIt] = minmax_element(data, data + n);
+    long long minKey = *minIt;
+    long long range = (long long)*maxIt - minKey + 1;
     
-    // Start with big gap, then reduce gap
-    for (int gap = n / 2; gap > 0; gap /= 2) {
-        // Do gapped insertion sort
-        for (int i = gap; i < n; i++) {
-            int temp = arr[i];
-            int j;
-            
-            // Shift earlier gap-sorted elements up
-            for (j = i; j >= gap && arr[j - gap] > temp; j -= gap) {
-                arr[j] = arr[j - gap];
+    int subs = range <= COUNTING_SUB_RANGE ? COUNTING_SUB_HISTOGRAMS : 1;
+    size_t histogramBytes = range * subs * sizeof(Count);
+    if (range > max<long long>(2 * n, 1LL << 16) || range * sizeof(Count) + histogramBytes > COUNTING_SORT_BUDGET)
+        return false;
+    
+    int threads = n >= (size_t)PARALLEL_SORT_CUTOFF ? sortThreadCount() : 1;
+    threads = (int)max<long long>(1, min<long long>(threads, COUNTING_SORT_BUDGET / histogramBytes - 1));
+    auto chunkStart = [&](int t) { return n * t / threads; };
+    
+    ScratchBuffer<Count> count((size_t)threads * subs * range, 0);
+    runParallel(threads, [&](int t) {
+        Count* local = &count[(size_t)t * subs * range];
+        size_t i = chunkStart(t), end = chunkStart(t + 1);
+        
+        if (subs == COUNTING_SUB_HISTOGRAMS) {
+            for (; i + 4 <= end; i += 4) {
+                local[data[i] - minKey]++;
+                local[range + (data[i + 1] - minKey)]++;
+                local[2 * range + (data[i + 2] - minKey)]++;
+                local[3 * range + (data[i + 3] - minKey)]++;
             }
-            
-            arr[j] = temp;
         }
-    }
+        for (; i < end; i++)
+            local[data[i] - minKey]++;
+    });
+    
+    // Fold every histogram into the first, then turn it into block starts
+    size_t histograms = (size_t)threads * subs;
+    for (size_t h = 1; h < histograms; h++)
+        for (long long k = 0; k < range; k++)
+            count[k] += count[h * range + k];
+    
+    ScratchBuffer<Count> start(range + 1, 0);
+    for (long long k = 0; k < range; k++)
+        start[k + 1] = start[k] + count[k];
+    
+    // Each thread rewrites one slice of the output, key block by key block
+    runParallel(threads, [&](int t) {
+        size_t i = chunkStart(t), end = chunkStart(t + 1);
+        long long k = upper_bound(start.begin(), start.end(), i) - start.begin() - 1;
+        
+        for (; i < end; k++) {
+            size_t blockEnd = min<size_t>(end, start[k + 1]);
+            fill(data + i, data + blockEnd, (Key)(minKey + k));
+            i = blockEnd;
+        }
+    });
+    
+    return true;
+}
+
+// Counting sort of plain keys, rewriting data straight from the counts with
+// no output buffer. Each thread counts its own chunk; small ranges (heavy
+// duplicates) spread consecutive elements over four sub-histograms so that
+// equal keys do not wait on each other's increment. Returns false, leaving
+// data untouched, when the range is too wide for the memory budget or too
+// sparse to beat radix sort.
+// Counters are 32-bit whenever n fits, 64-bit beyond.
+template <typename Key>
+bool countingSortKeys(Key* data, size_t n) {
+    if (n <= 1) return true;
+    if (n <= UINT32_MAX) return countingSortKeysWith<uint32_t>(data, n);
+    return countingSortKeysWith<uint64_t>(data, n);
+}
+
+void countingSort(vector<int>& arr) {
+    if (!countingSortKeys(arr.data(), arr.size()))
+        radixSort(arr);
+}
+
+// 8- and 16-bit codes always fit the budget
+void countingSort(vector<uint8_t>& arr) {
+    countingSortKeys(arr.data(), arr.size());
+}
+
+void countingSort(vector<uint16_t>& arr) {
+    countingSortKeys(arr.data(), arr.size());
 }
 
 // ==========================================================================
-// 11. COCKTAIL SHAKER SORT - O(n²) Time, O(1) Space
-// Bidirectional bubble sort
+// 8. RADIX SORT - O(d * (n + k)) Time, O(n + k) Space
+// Non-comparison based, sorts by 8-bit digits (d = 4 bytes, k = 256 buckets)
+// Least significant byte first; handles the full signed int range, plus
+// float, double and int64 keys through order-preserving bit transforms
 // ==========================================================================
 
-void cocktailShakerSort(vector<int>& arr) {
-    int n = arr.size();
-    bool swapped = true;
-    int start = 0;
-    int end = n - 1;
-    
-    while (swapped) {
-        swapped = false;
-        
-        // Forward pass
+const int RADIX_BITS = 8;
+const int RADIX_BUCKETS = 1 << RADIX_BITS;
+const int RADIX_PASSES = 32 / RADIX_BITS;
+
+// Flipping the sign bit makes unsigned byte order match signed int order
+inline unsigned radixKey(int x) {
+    return (unsigned)x ^ 0x80000000u;
+}
+
+// Builds the histograms of all four bytes in one read pass over data
+void radixHistograms(const int* data, int n, int* count) {
+    for (int i = 0; i < n; i++) {
+        unsigned key = radixKey(data[i]);
+        
+        for (int pass = 0; pass < RADIX_PASSES; pass++)
+            count[pass * RADIX_BUCKETS + ((key >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1))]++;
+    }
+}
+
+// Stable scatter of src into dst by the byte at shift.
+// count holds the starting offset of every bucket and is advanced in place.
+void countingSortForRadix(const int* src, int n, int* dst, int shift, int* count) {
+    for (int i = 0; i < n; i++) {
+        unsigned digit = (radixKey(src[i]) >> shift) & (RADIX_BUCKETS - 1);
+        dst[count[digit]++] = src[i];
+    }
+}
+
+void radixSort(vector<int>& arr) {
+    int n = arr.size();
+    if (n <= 1) return;
+    
+    ScratchBuffer<int> count(RADIX_PASSES * RADIX_BUCKETS, 0);
+    radixHistograms(arr.data(), n, count.data());
+    
+    ScratchBuffer<int> buffer(n);
+    int* src = arr.data();
+    int* dst = buffer.data();
+    
+    for (int pass = 0; pass < RADIX_PASSES; pass++) {
+        int shift = pass * RADIX_BITS;
+        int* passCount = &count[pass * RADIX_BUCKETS];
+        
+        // Skip the pass if every key has the same byte here
+        unsigned firstDigit = (radixKey(src[0]) >> shift) & (RADIX_BUCKETS - 1);
+        if (passCount[firstDigit] == n) continue;
+        
+        // Turn counts into starting offsets
+        int sum = 0;
+        for (int d = 0; d < RADIX_BUCKETS; d++) {
+            int c = passCount[d];
+            passCount[d] = sum;
+            sum += c;
+        }
+        
+        // Ping-pong: scatter into the other array, then make it the current one
+        countingSortForRadix(src, n, dst, shift, passCount);
+        swap(src, dst);
+    }
+    
+    if (src != arr.data())
+        copy(src, src + n, arr.data());
+}
+
+// Floating-point and 64-bit keys. Each value is mapped to an unsigned
+// integer with the same order (sign bit set for positives, all bits inverted
+// for negatives) and sorted by 11-bit digits: 3 passes for 32-bit keys and
+// 6 for 64-bit keys instead of 4 and 8. Keys are recomputed from the values
+// in every pass rather than stored, so NaN payloads and signed zeros come
+// back exactly as they went in.
+const int WIDE_RADIX_BITS = 11;
+const int WIDE_RADIX_BUCKETS = 1 << WIDE_RADIX_BITS;
+
+// Numeric: -0.0 and +0.0 are equal keys (stable), every NaN sorts last.
+// Total: IEEE 754 totalOrder, -NaN < -inf < ... < -0.0 < +0.0 < ... < +inf < +NaN.
+enum class FloatOrder { Numeric, Total };
+
+template <typename Float>
+auto floatRadixKey(Float x, FloatOrder order = FloatOrder::Numeric) {
+    typedef conditional_t<sizeof(Float) == 4, uint32_t, uint64_t> Unsigned;
+    const int width = sizeof(Float) * 8;
+    
+    if (order == FloatOrder::Numeric) {
+        if (isnan(x)) return ~Unsigned(0);
+        if (x == 0) x = 0; // -0.0 becomes +0.0
+    }
+    
+    Unsigned bits;
+    memcpy(&bits, &x, sizeof(bits));
+    Unsigned negative = Unsigned(0) - (bits >> (width - 1));
+    return Unsigned(bits ^ (negative | (Unsigned(1) << (width - 1))));
+}
+
+// LSD radix sort of data by keyOf(element), an unsigned integer
+template <typename T, typename KeyOf>
+void wideRadixSort(T* data, size_t n, KeyOf keyOf) {
+    typedef decltype(keyOf(*data)) Unsigned;
+    const int passes = (sizeof(Unsigned) * 8 + WIDE_RADIX_BITS - 1) / WIDE_RADIX_BITS;
+    if (n <= 1) return;
+    
+    auto digitOf = [&](const T& x, int pass) {
+        return (size_t)(keyOf(x) >> (pass * WIDE_RADIX_BITS)) & (WIDE_RADIX_BUCKETS - 1);
+    };
+    
+    // All histograms in one read pass
+    ScratchBuffer<size_t> count(passes * WIDE_RADIX_BUCKETS, 0);
+    for (size_t i = 0; i < n; i++) {
+        Unsigned key = keyOf(data[i]);
+        for (int pass = 0; pass < passes; pass++)
+            count[pass * WIDE_RADIX_BUCKETS + ((key >> (pass * WIDE_RADIX_BITS)) & (WIDE_RADIX_BUCKETS - 1))]++;
+    }
+    
+    ScratchBuffer<T> buffer(n);
+    T* src = data;
+    T* dst = buffer.data();
+    
+    for (int pass = 0; pass < passes; pass++) {
+        size_t* passCount = &count[pass * WIDE_RADIX_BUCKETS];
+        if (passCount[digitOf(src[0], pass)] == n) continue; // Digit is the same everywhere
+        
+        size_t sum = 0;
+        for (int d = 0; d < WIDE_RADIX_BUCKETS; d++) {
+            size_t c = passCount[d];
+            passCount[d] = sum;
+            sum += c;
+        }
+        
+        for (size_t i = 0; i < n; i++)
+            dst[passCount[digitOf(src[i], pass)]++] = src[i];
+        swap(src, dst);
+    }
+    
+    if (src != data)
+        copy(src, src + n, data);
+}
+
+void radixSort(vector<float>& arr, FloatOrder order = FloatOrder::Numeric) {
+    wideRadixSort(arr.data(), arr.size(), [order](float x) { return floatRadixKey(x, order); });
+}
+
+void radixSort(vector<double>& arr, FloatOrder order = FloatOrder::Numeric) {
+    wideRadixSort(arr.data(), arr.size(), [order](double x) { return floatRadixKey(x, order); });
+}
+
+void radixSort(vector<int64_t>& arr) {
+    wideRadixSort(arr.data(), arr.size(), [](int64_t x) { return (uint64_t)x ^ (uint64_t(1) << 63); });
+}
+
+// ==========================================================================
+// 9. BUCKET (SAMPLE) SORT - O(n log n / p) Time, O(n) Space
+// Distributes elements into buckets and sorts individually. Bucket bounds
+// come from a sorted random oversample, so any float or double range works;
+// all buckets live in one flat array sized by count/prefix offsets, and are
+// sorted in parallel. NaNs are placed last.
+// ==========================================================================
+
+const size_t SAMPLE_SORT_BASE = 1 << 12;  // Buckets this small go to std::sort
+const int SAMPLE_SORT_MAX_BUCKETS = 256;  // Bucket ids fit in one byte
+const int SAMPLE_SORT_OVERSAMPLING = 16;  // Sample elements per bucket
+
+// One distribution level: classify data into buckets through a branchless
+// search tree of splitters, scatter into buffer, copy back, then sort every
+// bucket (recursively while still large). buffer and oracle (one bucket id
+// per element) are shared by all levels, so no bucket allocates.
+template <typename Float>
+void sampleSortRecursive(Float* data, Float* buffer, uint8_t* oracle, size_t n, int threads) {
+    if (n <= SAMPLE_SORT_BASE) {
+        sort(data, data + n);
+        return;
+    }
+    
+    int buckets = 2, levels = 1;
+    while (buckets < SAMPLE_SORT_MAX_BUCKETS && buckets * SAMPLE_SORT_BASE < n) {
+        buckets *= 2;
+        levels++;
+    }
+    
+    // Every OVERSAMPLING-th element of a sorted random sample is a splitter
+    mt19937_64 rng(n);
+    ScratchBuffer<Float> sample(buckets * SAMPLE_SORT_OVERSAMPLING);
+    for (Float& x : sample) x = data[rng() % n];
+    sort(sample.begin(), sample.end());
+    
+    // Splitters in implicit-tree order: node j has children 2j and 2j + 1,
+    // and the leaf reached after `levels` steps, minus buckets, is the bucket.
+    // Node j on level d (2^d <= j < 2^(d + 1)) is splitter number
+    // (2 (j - 2^d) + 1) 2^(levels - d - 1) of an in-order walk.
+    ScratchBuffer<Float> tree(buckets);
+    for (int depth = 0; depth < levels; depth++)
+        for (int j = 1 << depth; j < 2 << depth; j++) {
+            int splitter = (2 * (j - (1 << depth)) + 1) << (levels - depth - 1);
+            tree[j] = sample[splitter * SAMPLE_SORT_OVERSAMPLING - 1];
+        }
+    
+    auto chunkStart = [&](int t) { return n * t / threads; };
+    ScratchBuffer<size_t> count((size_t)threads * buckets, 0);
+    
+    // Classification: four independent descents at a time keep the loads
+    // of one element's path from serializing the whole loop
+    runParallel(threads, [&](int t) {
+        size_t* local = &count[(size_t)t * buckets];
+        size_t i = chunkStart(t), end = chunkStart(t + 1);
+        
+        for (; i + 4 <= end; i += 4) {
+            size_t j0 = 1, j1 = 1, j2 = 1, j3 = 1;
+            for (int level = 0; level < levels; level++) {
+                j0 = 2 * j0 + (data[i] > tree[j0]);
+                j1 = 2 * j1 + (data[i + 1] > tree[j1]);
+                j2 = 2 * j2 + (data[i + 2] > tree[j2]);
+                j3 = 2 * j3 + (data[i + 3] > tree[j3]);
+            }
+            oracle[i] = j0 - buckets;
+            oracle[i + 1] = j1 - buckets;
+            oracle[i + 2] = j2 - buckets;
+            oracle[i + 3] = j3 - buckets;
+            local[j0 - buckets]++;
+            local[j1 - buckets]++;
+            local[j2 - buckets]++;
+            local[j3 - buckets]++;
+        }
+        
+        for (; i < end; i++) {
+            size_t j = 1;
+            for (int level = 0; level < levels; level++)
+                j = 2 * j + (data[i] > tree[j]);
+            oracle[i] = j - buckets;
+            local[j - buckets]++;
+        }
+    });
+    
+    // Bucket-major prefix sums: each thread gets its own slot in every bucket
+    ScratchBuffer<size_t> bucketStart(buckets + 1, 0);
+    size_t sum = 0;
+    for (int b = 0; b < buckets; b++) {
+        bucketStart[b] = sum;
+        for (int t = 0; t < threads; t++) {
+            size_t c = count[(size_t)t * buckets + b];
+            count[(size_t)t * buckets + b] = sum;
+            sum += c;
+        }
+    }
+    bucketStart[buckets] = n;
+    
+    runParallel(threads, [&](int t) {
+        size_t* offset = &count[(size_t)t * buckets];
+        for (size_t i = chunkStart(t); i < chunkStart(t + 1); i++)
+            buffer[offset[oracle[i]]++] = data[i];
+    });
+    
+    runParallel(threads, [&](int t) {
+        copy(buffer + chunkStart(t), buffer + chunkStart(t + 1), data + chunkStart(t));
+    });
+    
+    // Buckets are independent: threads claim them one at a time
+    atomic<int> nextBucket(0);
+    runParallel(threads, [&](int) {
+        for (int b; (b = nextBucket++) < buckets;) {
+            size_t start = bucketStart[b], size = bucketStart[b + 1] - start;
+            
+            // All splitters equal (heavy duplicates): no progress, stop splitting
+            if (size == n)
+                sort(data, data + n);
+            else
+                sampleSortRecursive(data + start, buffer + start, oracle + start, size, 1);
+        }
+    });
+}
+
+// Sorts any float or double range; NaNs go after every number
+template <typename Float>
+void sampleSort(Float* data, size_t n) {
+    static_assert(is_floating_point_v<Float>, "sampleSort sorts float or double");
+    
+    Float* numbersEnd = partition(data, data + n, [](Float x) { return !isnan(x); });
+    size_t m = numbersEnd - data;
+    if (m <= SAMPLE_SORT_BASE) {
+        sort(data, numbersEnd);
+        return;
+    }
+    
+    // Uninitialized scratch: no zeroing pass over up to n elements
+    ScratchBuffer<Float> buffer(m);
+    ScratchBuffer<uint8_t> oracle(m);
+    int threads = m >= (size_t)PARALLEL_SORT_CUTOFF ? sortThreadCount() : 1;
+    sampleSortRecursive(data, buffer.data(), oracle.data(), m, threads);
+}
+
+void sampleSort(vector<float>& arr) {
+    sampleSort(arr.data(), arr.size());
+}
+
+void sampleSort(vector<double>& arr) {
+    sampleSort(arr.data(), arr.size());
+}
+
+// Kept for existing callers; no longer limited to [0, 1)
+void bucketSort(vector<float>& arr) {
+    sampleSort(arr);
+}
+
+// ==========================================================================
+// 10. SHELL SORT - O(n log n) to O(n²) Time, O(1) Space
+// Improved insertion sort with gap sequence
+// ==========================================================================
+
+template <typename Stats = NullStats>
+void shellSort(vector<int>& arr, Stats&& stats = Stats()) {
+    int n = arr.size();
+    
+    // Start with big gap, then reduce gap
+    for (int gap = n / 2; gap > 0; gap /= 2) {
+        // Do gapped insertion sort
+        for (int i = gap; i < n; i++) {
+            int temp = arr[i];
+            int j;
+            
+            // Shift earlier gap-sorted elements up
+            for (j = i; j >= gap && (stats.comparison(), arr[j - gap] > temp); j -= gap) {
+                arr[j] = arr[j - gap];
+                stats.move();
+            }
+            
+            arr[j] = temp;
+            stats.move();
+        }
+    }
+}
+
+// ==========================================================================
+// 11. COCKTAIL SHAKER SORT - O(n²) Time, O(1) Space
+// Bidirectional bubble sort
+// ==========================================================================
+
+template <typename Stats = NullStats>
+void cocktailShakerSort(vector<int>& arr, Stats&& stats = Stats()) {
+    int n = arr.size();
+    bool swapped = true;
+    int start = 0;
+    int end = n - 1;
+    
+    while (swapped) {
+        swapped = false;
+        
+        // Forward pass
         for (int i = start; i < end; i++) {
+            stats.comparison();
             if (arr[i] > arr[i + 1]) {
                 swap(arr[i], arr[i + 1]);
+                stats.swap();
+                swapped = true;
+            }
+        }
+        
+        if (!swapped) break;
+        
+        end--;
+        swapped = false;
+        
+        // Backward pass
+        for (int i = end; i > start; i--) {
+            stats.comparison();
+            if (arr[i] < arr[i - 1]) {
+                swap(arr[i], arr[i - 1]);
+                stats.swap();
+                swapped = true;
+            }
+        }
+        
+        start++;
+    }
+}
+
+// ==========================================================================
+// 12. COMB SORT - O(n log n) Average, O(n²) Worst, O(1) Space
+// Improved bubble sort with shrinking gap
+// ==========================================================================
+
+template <typename Stats = NullStats>
+void combSort(vector<int>& arr, Stats&& stats = Stats()) {
+    int n = arr.size();
+    int gap = n;
+    bool swapped = true;
+    
+    while (gap != 1 || swapped) {
+        // Find next gap
+        gap = (gap * 10) / 13;
+        if (gap < 1) gap = 1;
+        
+        swapped = false;
+        
+        // Compare all elements with current gap
+        for (int i = 0; i < n - gap; i++) {
+            stats.comparison();
+            if (arr[i] > arr[i + gap]) {
+                swap(arr[i], arr[i + gap]);
+                stats.swap();
                 swapped = true;
             }
         }
+    }
+}
+
+// ==========================================================================
+// 13. PARALLEL MERGE SORT - O(n log n / p) Time, O(n) Space
+// Task-parallel stable merge sort with one ping-pong buffer and merge-path
+// splitting of large merges across cores
+// ==========================================================================
+
+// Merges sorted a[0..n1) and b[0..n2) into out, taking from a on ties (stable)
+void mergeRuns(const int* a, int n1, const int* b, int n2, int* out) {
+    int i = 0, j = 0, k = 0;
+    
+    while (i < n1 && j < n2) {
+        if (a[i] <= b[j])
+            out[k++] = a[i++];
+        else
+            out[k++] = b[j++];
+    }
+    
+    while (i < n1) out[k++] = a[i++];
+    while (j < n2) out[k++] = b[j++];
+}
+
+// Merge path: how many of the first diag merged outputs come from a.
+// Binary search along the diagonal, ties resolved in favour of a.
+int mergePathSplit(const int* a, int n1, const int* b, int n2, int diag) {
+    int low = max(0, diag - n2);
+    int high = min(diag, n1);
+    
+    while (low < high) {
+        int i = low + (high - low) / 2;
+        
+        if (a[i] <= b[diag - i - 1])
+            low = i + 1;
+        else
+            high = i;
+    }
+    
+    return low;
+}
+
+// Splits the output into equal slices and merges each slice on its own thread
+void parallelMerge(const int* a, int n1, const int* b, int n2, int* out, int threads) {
+    int total = n1 + n2;
+    
+    if (threads <= 1 || total < PARALLEL_SORT_CUTOFF) {
+        mergeRuns(a, n1, b, n2, out);
+        return;
+    }
+    
+    runParallel(threads, [&](int t) {
+        int diagStart = (long long)total * t / threads;
+        int diagEnd = (long long)total * (t + 1) / threads;
+        
+        int aStart = mergePathSplit(a, n1, b, n2, diagStart);
+        int aEnd = mergePathSplit(a, n1, b, n2, diagEnd);
+        int bStart = diagStart - aStart;
+        int bEnd = diagEnd - aEnd;
+        
+        mergeRuns(a + aStart, aEnd - aStart, b + bStart, bEnd - bStart, out + diagStart);
+    });
+}
+
+// Sorts [left, right) into dst, using src as scratch.
+// Both arrays must hold the same elements on entry; roles swap every level.
+void parallelMergeSortHelper(int* src, int* dst, int left, int right, int threads) {
+    int n = right - left;
+    
+    if (n <= SORTING_NETWORK_MAX) {
+        sortSmallBlock(dst + left, n);
+        return;
+    }
+    
+    int mid = left + n / 2;
+    
+    // Sort both halves into src, then merge them back into dst
+    if (threads > 1 && n >= PARALLEL_SORT_CUTOFF) {
+        int leftThreads = threads / 2;
+        runParallel(2, [&](int half) {
+            if (half == 0)
+                parallelMergeSortHelper(dst, src, mid, right, threads - leftThreads);
+            else
+                parallelMergeSortHelper(dst, src, left, mid, leftThreads);
+        });
+    } else {
+        parallelMergeSortHelper(dst, src, left, mid, 1);
+        parallelMergeSortHelper(dst, src, mid, right, 1);
+    }
+    
+    parallelMerge(src + left, mid - left, src + mid, right - mid, dst + left, threads);
+}
+
+void parallelMergeSort(vector<int>& arr) {
+    int n = arr.size();
+    if (n <= 1) return;
+    
+    // The only scratch: one ping-pong buffer for the whole sort
+    ScratchBuffer<int> buffer(arr.begin(), arr.end());
+    parallelMergeSortHelper(buffer.data(), arr.data(), 0, n, sortThreadCount());
+}
+
+// ==========================================================================
+// 14. PATTERN-DEFEATING QUICK SORT - O(n log n) Worst, O(log n) Space
+// Introspective hybrid: quick sort with ninther pivots, heap sort fallback
+// once partitions go bad, insertion sort for small ranges, and early exit
+// on inputs that are already partitioned (sorted, reversed, organ-pipe)
+// ==========================================================================
+
+const int INSERTION_SORT_THRESHOLD = 24; // Ranges this small use insertion sort
+const int NINTHER_THRESHOLD = 128;       // Ranges this large use a ninther pivot
+const int PARTIAL_INSERTION_LIMIT = 8;   // Element moves before giving up
+
+// Insertion sort that gives up once it has moved too many elements.
+// Returns true if arr[low..high] ended up sorted.
+bool partialInsertionSort(vector<int>& arr, int low, int high) {
+    int moves = 0;
+    
+    for (int i = low + 1; i <= high; i++) {
+        if (arr[i - 1] <= arr[i]) continue;
+        
+        int key = arr[i];
+        int j = i - 1;
+        
+        while (j >= low && arr[j] > key) {
+            arr[j + 1] = arr[j];
+            j--;
+        }
+        
+        arr[j + 1] = key;
+        moves += i - (j + 1);
+        
+        if (moves > PARTIAL_INSERTION_LIMIT) return false;
+    }
+    
+    return true;
+}
+
+// Hoare-style partition around the pivot stored at arr[low].
+// Elements < pivot end up left, elements >= pivot right. Requires an element
+// >= pivot somewhere after low (guaranteed by median-of-three / ninther).
+int partitionRight(vector<int>& arr, int low, int high, bool& alreadyPartitioned) {
+    int pivot = arr[low];
+    int first = low;
+    int last = high + 1;
+    
+    // Find the first element >= pivot and the last element < pivot
+    while (arr[++first] < pivot);
+    
+    if (first - 1 == low) {
+        while (first < last && !(arr[--last] < pivot));
+    } else {
+        while (!(arr[--last] < pivot));
+    }
+    
+    // No misplaced pair means the range was already partitioned
+    alreadyPartitioned = first >= last;
+    
+    while (first < last) {
+        swap(arr[first], arr[last]);
+        while (arr[++first] < pivot);
+        while (!(arr[--last] < pivot));
+    }
+    
+    int pivotPos = first - 1;
+    arr[low] = arr[pivotPos];
+    arr[pivotPos] = pivot;
+    return pivotPos;
+}
+
+// Swaps a few elements of an unbalanced partition to break up adversarial patterns
+void breakPatterns(vector<int>& arr, int low, int high) {
+    int size = high - low + 1;
+    if (size < INSERTION_SORT_THRESHOLD) return;
+    
+    swap(arr[low], arr[low + size / 4]);
+    swap(arr[high], arr[high - size / 4]);
+    
+    if (size > NINTHER_THRESHOLD) {
+        swap(arr[low + 1], arr[low + size / 4 + 1]);
+        swap(arr[low + 2], arr[low + size / 4 + 2]);
+        swap(arr[high - 1], arr[high - size / 4 - 1]);
+        swap(arr[high - 2], arr[high - size / 4 - 2]);
+    }
+}
+
+void pdqSortHelper(vector<int>& arr, int low, int high, int badAllowed, bool leftmost) {
+    while (true) {
+        int size = high - low + 1;
+        
+        if (size < INSERTION_SORT_THRESHOLD) {
+            insertionSortRange(arr, low, high);
+            return;
+        }
+        
+        // Move the chosen pivot to arr[low]
+        int mid = low + size / 2;
+        if (size > NINTHER_THRESHOLD) {
+            sort3(arr, low, mid, high);
+            sort3(arr, low + 1, mid - 1, high - 1);
+            sort3(arr, low + 2, mid + 1, high - 2);
+            sort3(arr, mid - 1, mid, mid + 1);
+            swap(arr[low], arr[mid]);
+        } else {
+            swap(arr[low], arr[medianOfThree(arr, low, high)]);
+        }
+        
+        // Every element here is >= arr[low - 1]. If the pivot equals it, the
+        // standard partition gathers all copies of the pivot on the left and
+        // they never need to be looked at again.
+        if (!leftmost && !(arr[low - 1] < arr[low])) {
+            swap(arr[low], arr[high]);
+            low = partition(arr, low, high) + 1;
+            continue;
+        }
+        
+        bool alreadyPartitioned;
+        int pivotPos = partitionRight(arr, low, high, alreadyPartitioned);
+        
+        int leftSize = pivotPos - low;
+        int rightSize = high - pivotPos;
+        bool highlyUnbalanced = leftSize < size / 8 || rightSize < size / 8;
+        
+        if (highlyUnbalanced) {
+            // Too many bad partitions: fall back to heap sort for O(n log n)
+            if (--badAllowed == 0) {
+                heapSortRange(arr, low, high);
+                return;
+            }
+            
+            breakPatterns(arr, low, pivotPos - 1);
+            breakPatterns(arr, pivotPos + 1, high);
+        } else if (alreadyPartitioned &&
+                   partialInsertionSort(arr, low, pivotPos - 1) &&
+                   partialInsertionSort(arr, pivotPos + 1, high)) {
+            // Both sides were (nearly) sorted already
+            return;
+        }
+        
+        // Recurse into the smaller side, loop on the larger one (O(log n) stack)
+        if (leftSize < rightSize) {
+            pdqSortHelper(arr, low, pivotPos - 1, badAllowed, leftmost);
+            low = pivotPos + 1;
+            leftmost = false;
+        } else {
+            pdqSortHelper(arr, pivotPos + 1, high, badAllowed, false);
+            high = pivotPos - 1;
+        }
+    }
+}
+
+// Sorts arr[low..high]
+void pdqSortRange(vector<int>& arr, int low, int high) {
+    int n = high - low + 1;
+    if (n <= 1) return;
+    
+    // Allow about log2(n) bad partitions before switching to heap sort
+    int badAllowed = 1;
+    while (n >>= 1) badAllowed++;
+    
+    pdqSortHelper(arr, low, high, badAllowed, true);
+}
+
+void pdqSort(vector<int>& arr) {
+    pdqSortRange(arr, 0, arr.size() - 1);
+}
+
+// ==========================================================================
+// 15. PARALLEL RADIX SORT - O(d * n / p) Time, O(n + p * k) Space
+// MSD pass on the highest varying byte with per-thread histograms and
+// write-combining scatter, then every bucket finished independently by LSD
+// ==========================================================================
+
+const int WRITE_COMBINE_SIZE = 16; // Ints per write-combining buffer (one cache line)
+
+// LSD radix sort of data[0..n) on its lowest `passes` bytes, ping-ponging
+// with scratch. Returns whichever of the two arrays holds the sorted result.
+int* lsdRadixSortRange(int* data, int* scratch, int n, int passes) {
+    int count[RADIX_PASSES][RADIX_BUCKETS] = {};
+    
+    for (int i = 0; i < n; i++) {
+        unsigned key = radixKey(data[i]);
+        for (int pass = 0; pass < passes; pass++)
+            count[pass][(key >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1)]++;
+    }
+    
+    int* src = data;
+    int* dst = scratch;
+    
+    for (int pass = 0; pass < passes; pass++) {
+        int shift = pass * RADIX_BITS;
+        if (count[pass][(radixKey(src[0]) >> shift) & (RADIX_BUCKETS - 1)] == n) continue;
+        
+        int sum = 0;
+        for (int d = 0; d < RADIX_BUCKETS; d++) {
+            int c = count[pass][d];
+            count[pass][d] = sum;
+            sum += c;
+        }
+        
+        for (int i = 0; i < n; i++)
+            dst[count[pass][(radixKey(src[i]) >> shift) & (RADIX_BUCKETS - 1)]++] = src[i];
+        
+        swap(src, dst);
+    }
+    
+    return src;
+}
+
+void parallelRadixSort(vector<int>& arr) {
+    int n = arr.size();
+    int threads = sortThreadCount();
+    
+    if (threads <= 1 || n < PARALLEL_SORT_CUTOFF) {
+        radixSort(arr);
+        return;
+    }
+    
+    auto chunkStart = [&](int t) { return (int)((long long)n * t / threads); };
+    
+    // Per-thread histograms of every byte, built in one pass over each chunk
+    ScratchBuffer<int> count(threads * RADIX_PASSES * RADIX_BUCKETS, 0);
+    runParallel(threads, [&](int t) {
+        int* local = &count[t * RADIX_PASSES * RADIX_BUCKETS];
+        for (int i = chunkStart(t); i < chunkStart(t + 1); i++) {
+            unsigned key = radixKey(arr[i]);
+            for (int pass = 0; pass < RADIX_PASSES; pass++)
+                local[pass * RADIX_BUCKETS + ((key >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1))]++;
+        }
+    });
+    
+    // Partition on the most significant byte that actually varies
+    int msdPass = RADIX_PASSES - 1;
+    while (msdPass >= 0) {
+        unsigned digit = (radixKey(arr[0]) >> (msdPass * RADIX_BITS)) & (RADIX_BUCKETS - 1);
+        int total = 0;
+        for (int t = 0; t < threads; t++)
+            total += count[(t * RADIX_PASSES + msdPass) * RADIX_BUCKETS + digit];
+        if (total != n) break;
+        msdPass--;
+    }
+    if (msdPass < 0) return; // All keys are equal
+    
+    auto msdCount = [&](int t) { return &count[(t * RADIX_PASSES + msdPass) * RADIX_BUCKETS]; };
+    
+    // Prefix sum: bucket totals in parallel over digit slices, a tiny serial
+    // scan over the 256 totals, then every thread derives its own offsets
+    ScratchBuffer<int> bucketStart(RADIX_BUCKETS + 1, 0);
+    runParallel(threads, [&](int t) {
+        for (int d = RADIX_BUCKETS * t / threads; d < RADIX_BUCKETS * (t + 1) / threads; d++)
+            for (int u = 0; u < threads; u++)
+                bucketStart[d + 1] += msdCount(u)[d];
+    });
+    for (int d = 0; d < RADIX_BUCKETS; d++)
+        bucketStart[d + 1] += bucketStart[d];
+    
+    ScratchBuffer<int> offset(threads * RADIX_BUCKETS);
+    runParallel(threads, [&](int t) {
+        for (int d = 0; d < RADIX_BUCKETS; d++) {
+            int start = bucketStart[d];
+            for (int u = 0; u < t; u++)
+                start += msdCount(u)[d];
+            offset[t * RADIX_BUCKETS + d] = start;
+        }
+    });
+    
+    // Scatter through cache-line sized staging buffers, so every write to the
+    // destination is a full line instead of 256 interleaved partial ones
+    ScratchBuffer<int> buffer(n);
+    int msdShift = msdPass * RADIX_BITS;
+    runParallel(threads, [&](int t) {
+        ScratchBuffer<int> staging(RADIX_BUCKETS * WRITE_COMBINE_SIZE);
+        int fill[RADIX_BUCKETS] = {};
+        int* out = &offset[t * RADIX_BUCKETS];
+        
+        for (int i = chunkStart(t); i < chunkStart(t + 1); i++) {
+            unsigned digit = (radixKey(arr[i]) >> msdShift) & (RADIX_BUCKETS - 1);
+            int* line = &staging[digit * WRITE_COMBINE_SIZE];
+            line[fill[digit]++] = arr[i];
+            
+            if (fill[digit] == WRITE_COMBINE_SIZE) {
+                copy(line, line + WRITE_COMBINE_SIZE, &buffer[out[digit]]);
+                out[digit] += WRITE_COMBINE_SIZE;
+                fill[digit] = 0;
+            }
+        }
+        
+        for (int d = 0; d < RADIX_BUCKETS; d++) {
+            int* line = &staging[d * WRITE_COMBINE_SIZE];
+            copy(line, line + fill[d], &buffer[out[d]]);
+        }
+    });
+    
+    // Buckets are independent now: threads claim them one at a time and
+    // finish each with LSD passes on the lower bytes, no global barriers
+    atomic<int> nextBucket(0);
+    runParallel(threads, [&](int) {
+        for (int d = nextBucket++; d < RADIX_BUCKETS; d = nextBucket++) {
+            int start = bucketStart[d];
+            int size = bucketStart[d + 1] - start;
+            if (size == 0) continue;
+            
+            int* sorted = lsdRadixSortRange(&buffer[start], &arr[start], size, msdPass);
+            if (sorted != &arr[start])
+                copy(sorted, sorted + size, &arr[start]);
+        }
+    });
+}
+
+// ==========================================================================
+// 16. SORTING NETWORKS - O(n log² n) Comparators, O(1) Space, n <= 64
+// Branch-free bitonic networks on SIMD registers, used as the leaf case of
+// the divide-and-conquer sorts. Build with -mavx2 or -msse4.1 (or
+// -march=native) to enable the vector kernels.
+// ==========================================================================
+
+#if defined(__AVX2__)
+
+const char* SORTING_NETWORK_KERNEL = "AVX2";
+
+struct SimdInts {
+    typedef __m256i Reg;
+    static const int LANES = 8;
+    
+    static Reg load(const int* p) { return _mm256_loadu_si256((const __m256i*)p); }
+    static void store(int* p, Reg v) { _mm256_storeu_si256((__m256i*)p, v); }
+    static Reg lower(Reg a, Reg b) { return _mm256_min_epi32(a, b); }
+    static Reg upper(Reg a, Reg b) { return _mm256_max_epi32(a, b); }
+    
+    static Reg reverse(Reg v) {
+        return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+    }
+    
+    // One network layer: every lane meets the lane partner moved into it,
+    // lanes set in MaxLanes keep the larger value
+    template <int MaxLanes>
+    static Reg exchange(Reg v, Reg partner) {
+        return _mm256_blend_epi32(lower(v, partner), upper(v, partner), MaxLanes);
+    }
+    
+    // Batcher odd-even merge network on the 8 lanes (19 comparators, 6 layers)
+    static Reg sortLanes(Reg v) {
+        v = exchange<0xAA>(v, _mm256_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+        v = exchange<0xCC>(v, _mm256_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+        v = exchange<0x44>(v, _mm256_shuffle_epi32(v, _MM_SHUFFLE(3, 1, 2, 0)));
+        v = exchange<0xF0>(v, _mm256_permute2x128_si256(v, v, 1));
+        v = exchange<0x30>(v, _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 1, 4, 5, 2, 3, 6, 7)));
+        v = exchange<0x54>(v, _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 2, 1, 4, 3, 6, 5, 7)));
+        return v;
+    }
+    
+    // Sorts a bitonic register with half-cleaners of stride 4, 2, 1
+    static Reg mergeLanes(Reg v) {
+        v = exchange<0xF0>(v, _mm256_permute2x128_si256(v, v, 1));
+        v = exchange<0xCC>(v, _mm256_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+        v = exchange<0xAA>(v, _mm256_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+        return v;
+    }
+};
+
+#elif defined(__SSE4_1__)
+
+const char* SORTING_NETWORK_KERNEL = "SSE4.1";
+
+struct SimdInts {
+    typedef __m128i Reg;
+    static const int LANES = 4;
+    
+    static Reg load(const int* p) { return _mm_loadu_si128((const __m128i*)p); }
+    static void store(int* p, Reg v) { _mm_storeu_si128((__m128i*)p, v); }
+    static Reg lower(Reg a, Reg b) { return _mm_min_epi32(a, b); }
+    static Reg upper(Reg a, Reg b) { return _mm_max_epi32(a, b); }
+    static Reg reverse(Reg v) { return _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3)); }
+    
+    // MaxLanes is a 16-bit lane mask: two bits per int lane
+    template <int MaxLanes>
+    static Reg exchange(Reg v, Reg partner) {
+        return _mm_blend_epi16(lower(v, partner), upper(v, partner), MaxLanes);
+    }
+    
+    // Optimal 4-input network (5 comparators, 3 layers)
+    static Reg sortLanes(Reg v) {
+        v = exchange<0xCC>(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+        v = exchange<0xF0>(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+        v = exchange<0x30>(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 1, 2, 0)));
+        return v;
+    }
+    
+    // Sorts a bitonic register with half-cleaners of stride 2, 1
+    static Reg mergeLanes(Reg v) {
+        v = exchange<0xF0>(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+        v = exchange<0xCC>(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+        return v;
+    }
+};
+
+#endif
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+
+// Sorts a bitonic sequence spread over count registers (count a power of two)
+void bitonicMergeRegisters(SimdInts::Reg* v, int count) {
+    for (int stride = count / 2; stride > 0; stride /= 2) {
+        for (int i = 0; i < count; i++) {
+            if ((i & stride) == 0) {
+                SimdInts::Reg low = SimdInts::lower(v[i], v[i + stride]);
+                v[i + stride] = SimdInts::upper(v[i], v[i + stride]);
+                v[i] = low;
+            }
+        }
+    }
+    
+    for (int i = 0; i < count; i++)
+        v[i] = SimdInts::mergeLanes(v[i]);
+}
+
+// Merges two sorted registers: a gets the smaller half, b the larger
+void bitonicMerge(SimdInts::Reg& a, SimdInts::Reg& b) {
+    SimdInts::Reg reversed = SimdInts::reverse(b);
+    b = SimdInts::mergeLanes(SimdInts::upper(a, reversed));
+    a = SimdInts::mergeLanes(SimdInts::lower(a, reversed));
+}
+
+void sortSmallBlock(int* arr, int n) {
+    const int LANES = SimdInts::LANES;
+    if (n <= 1) return;
+    
+    // Pad with INT_MAX up to a power-of-two number of registers
+    int regs = 1;
+    while (regs * LANES < n) regs *= 2;
+    
+    int padded[SORTING_NETWORK_MAX];
+    copy(arr, arr + n, padded);
+    fill(padded + n, padded + regs * LANES, INT_MAX);
+    
+    SimdInts::Reg v[SORTING_NETWORK_MAX / LANES];
+    for (int r = 0; r < regs; r++)
+        v[r] = SimdInts::sortLanes(SimdInts::load(padded + r * LANES));
+    
+    // Merge sorted runs of registers pairwise until one run is left
+    for (int r = 0; r + 1 < regs; r += 2)
+        bitonicMerge(v[r], v[r + 1]);
+    
+    for (int width = 2; width < regs; width *= 2) {
+        for (int group = 0; group < regs; group += 2 * width) {
+            // Reversing the second run turns the pair into one bitonic sequence
+            SimdInts::Reg* second = v + group + width;
+            for (int i = 0; i < width / 2; i++) {
+                SimdInts::Reg tmp = SimdInts::reverse(second[i]);
+                second[i] = SimdInts::reverse(second[width - 1 - i]);
+                second[width - 1 - i] = tmp;
+            }
+            
+            bitonicMergeRegisters(v + group, 2 * width);
+        }
+    }
+    
+    for (int r = 0; r < regs; r++)
+        SimdInts::store(padded + r * LANES, v[r]);
+    copy(padded, padded + n, arr);
+}
+
+#else
+
+const char* SORTING_NETWORK_KERNEL = "scalar";
+
+// Without SIMD min/max a scalar bitonic network does ~10x the work of
+// insertion sort at these sizes and measures about 2x slower, so scalar
+// builds keep insertion sort as the leaf case
+void sortSmallBlock(int* arr, int n) {
+    for (int i = 1; i < n; i++) {
+        int key = arr[i];
+        int j = i - 1;
+        
+        while (j >= 0 && arr[j] > key) {
+            arr[j + 1] = arr[j];
+            j--;
+        }
+        
+        arr[j + 1] = key;
+    }
+}
+
+#endif
+
+// ==========================================================================
+// 17. GENERIC SORTING - Iterators, Comparators and Key Projections
+// The algorithms above as templates over any random-access range (vector,
+// array, raw pointer, std::span via span.begin()/span.end()), so uint64 IDs,
+// doubles and structs sort where they live instead of being copied into a
+// vector<int>. Keys are compared as comp(proj(a), proj(b)); arithmetic keys
+// in natural order get branchless and radix paths chosen at compile time.
+// ==========================================================================
+
+// Default projection: every element is its own key
+struct Identity {
+    template <typename T>
+    constexpr T&& operator()(T&& x) const { return std::forward<T>(x); }
+};
+
+template <typename RandomIt, typename Proj>
+using ProjectedKey = decay_t<invoke_result_t<Proj&, typename iterator_traits<RandomIt>::reference>>;
+
+// The one comparison every generic sort makes: comp(proj(a), proj(b))
+template <typename Compare, typename Proj>
+struct ProjectedCompare {
+    Compare& comp;
+    Proj& proj;
+    
+    template <typename A, typename B>
+    bool operator()(const A& a, const B& b) const {
+        return invoke(comp, invoke(proj, a), invoke(proj, b));
+    }
+};
+
+template <typename Compare, typename Key>
+constexpr bool isNaturalOrder = is_same_v<Compare, less<>> || is_same_v<Compare, less<Key>>;
+
+template <typename Key>
+constexpr bool isRadixKey =
+    (is_integral_v<Key> && !is_same_v<Key, bool>) || is_same_v<Key, float> || is_same_v<Key, double>;
+
+// Iterators known to walk contiguous storage, which can be addressed through a T*
+template <typename RandomIt, typename T = typename iterator_traits<RandomIt>::value_type>
+constexpr bool isContiguousIterator =
+    !is_same_v<T, bool> && (is_same_v<RandomIt, T*> || is_same_v<RandomIt, typename vector<T>::iterator>);
+
+// Ranges of ints in ascending order can use the sorting network directly
+template <typename RandomIt, typename Compare, typename Proj>
+constexpr bool isPlainIntRange =
+    (is_same_v<RandomIt, int*> || is_same_v<RandomIt, vector<int>::iterator>) &&
+    is_same_v<Proj, Identity> && isNaturalOrder<Compare, int>;
+
+// Small, cheaply swapped elements ordered by an arithmetic key can afford the
+// unconditional swaps of the branchless partition
+template <typename RandomIt, typename Compare, typename Proj>
+constexpr bool useBranchlessPartition =
+    is_arithmetic_v<ProjectedKey<RandomIt, Proj>> &&
+    isNaturalOrder<Compare, ProjectedKey<RandomIt, Proj>> &&
+    is_trivially_copyable_v<typename iterator_traits<RandomIt>::value_type> &&
+    sizeof(typename iterator_traits<RandomIt>::value_type) <= 16;
+
+const int GENERIC_INSERTION_THRESHOLD = 16;
+
+// Order-preserving map of an integral or floating-point key onto an unsigned
+// integer of equal width (floats in FloatOrder::Numeric, NaNs last)
+template <typename Key>
+auto radixKeyOf(Key key) {
+    if constexpr (is_floating_point_v<Key>) {
+        return floatRadixKey(key);
+    } else {
+        typedef make_unsigned_t<Key> Unsigned;
+        
+        if constexpr (is_signed_v<Key>)
+            return Unsigned(Unsigned(key) ^ (Unsigned(1) << (sizeof(Key) * 8 - 1)));
+        else
+            return Unsigned(key);
+    }
+}
+
+template <typename RandomIt, typename Compare = less<>, typename Proj = Identity>
+void bubbleSort(RandomIt first, RandomIt last, Compare comp = Compare(), Proj proj = Proj()) {
+    ProjectedCompare<Compare, Proj> before{comp, proj};
+    auto n = last - first;
+    
+    for (decltype(n) i = 0; i < n - 1; i++) {
+        bool swapped = false;
+        
+        for (decltype(n) j = 0; j < n - i - 1; j++) {
+            if (before(first[j + 1], first[j])) {
+                iter_swap(first + j, first + j + 1);
+                swapped = true;
+            }
+        }
+        
+        if (!swapped) break;
+    }
+}
+
+template <typename RandomIt, typename Compare = less<>, typename Proj = Identity>
+void selectionSort(RandomIt first, RandomIt last, Compare comp = Compare(), Proj proj = Proj()) {
+    ProjectedCompare<Compare, Proj> before{comp, proj};
+    
+    for (RandomIt i = first; i < last; ++i) {
+        RandomIt minIt = i;
+        
+        for (RandomIt j = i + 1; j < last; ++j)
+            if (before(*j, *minIt)) minIt = j;
+        
+        if (minIt != i) iter_swap(i, minIt);
+    }
+}
+
+template <typename RandomIt, typename Compare = less<>, typename Proj = Identity>
+void insertionSort(RandomIt first, RandomIt last, Compare comp = Compare(), Proj proj = Proj()) {
+    ProjectedCompare<Compare, Proj> before{comp, proj};
+    if (last - first <= 1) return;
+    
+    for (RandomIt i = first + 1; i < last; ++i) {
+        auto key = std::move(*i);
+        RandomIt j = i;
+        
+        while (j > first && before(key, *(j - 1))) {
+            *j = std::move(*(j - 1));
+            --j;
+        }
+        
+        *j = std::move(key);
+    }
+}
+
+// Leaf case of the generic divide-and-conquer sorts
+template <typename RandomIt, typename Compare, typename Proj>
+void genericSmallSort(RandomIt first, RandomIt last, Compare& comp, Proj& proj) {
+    if constexpr (isPlainIntRange<RandomIt, Compare, Proj>) {
+        if (last - first > 1) sortSmallBlock(&*first, last - first);
+    } else {
+        insertionSort(first, last, comp, proj);
+    }
+}
+
+template <typename RandomIt, typename Compare, typename Proj, typename T>
+void genericMergeSortHelper(RandomIt first, RandomIt last, T* buffer, Compare& comp, Proj& proj) {
+    ProjectedCompare<Compare, Proj> before{comp, proj};
+    auto n = last - first;
+    
+    if (n <= GENERIC_INSERTION_THRESHOLD) {
+        insertionSort(first, last, comp, proj);
+        return;
+    }
+    
+    RandomIt mid = first + n / 2;
+    genericMergeSortHelper(first, mid, buffer, comp, proj);
+    genericMergeSortHelper(mid, last, buffer, comp, proj);
+    
+    // Halves already in order: nothing to merge
+    if (!before(*mid, *(mid - 1))) return;
+    
+    // Move the left half out, then merge back; right wins only when strictly smaller
+    T* left = buffer;
+    T* leftEnd = move(first, mid, buffer);
+    RandomIt right = mid, out = first;
+    
+    while (left < leftEnd && right < last) {
+        if (before(*right, *left))
+            *out++ = std::move(*right++);
+        else
+            *out++ = std::move(*left++);
+    }
+    
+    move(left, leftEnd, out);
+}
+
+template <typename RandomIt, typename Compare = less<>, typename Proj = Identity>
+void mergeSort(RandomIt first, RandomIt last, Compare comp = Compare(), Proj proj = Proj()) {
+    typedef typename iterator_traits<RandomIt>::value_type T;
+    auto n = last - first;
+    if (n <= 1) return;
+    
+    // One buffer for the whole sort, large enough for the left half of any merge
+    ScratchBuffer<T> buffer((n + 1) / 2);
+    genericMergeSortHelper(first, last, buffer.data(), comp, proj);
+}
+
+template <typename RandomIt, typename Compare = less<>, typename Proj = Identity>
+void heapSort(RandomIt first, RandomIt last, Compare comp = Compare(), Proj proj = Proj()) {
+    using T = typename iterator_traits<RandomIt>::value_type;
+    ProjectedCompare<Compare, Proj> before{comp, proj};
+    NullStats stats;
+    if (last - first < 2) return;
+    
+    // Through a pointer, the heap can start on a cache-line group
+    if constexpr (isContiguousIterator<RandomIt>)
+        daryHeapSort<heapArity<T>>(&*first, last - first, before, stats);
+    else
+        daryHeapSort<heapArity<T>>(first, last - first, before, stats);
+}
+
+// Hoare partition around *first; stops on equal keys so duplicates split evenly
+template <typename RandomIt, typename Before>
+RandomIt partitionHoare(RandomIt first, RandomIt last, Before before) {
+    RandomIt i = first, j = last;
+    
+    while (true) {
+        do ++i; while (i < last && before(*i, *first));
+        do --j; while (before(*first, *j));
+        if (i >= j) break;
+        iter_swap(i, j);
+    }
+    
+    iter_swap(first, j);
+    return j;
+}
+
+// Lomuto partition around *first with no data-dependent branch: every
+// element is swapped unconditionally and goesLeft only moves the boundary
+template <typename RandomIt, typename GoesLeft>
+RandomIt partitionBranchless(RandomIt first, RandomIt last, GoesLeft goesLeft) {
+    RandomIt boundary = first + 1;
+    
+    for (RandomIt it = first + 1; it < last; ++it) {
+        bool left = goesLeft(*it);
+        iter_swap(it, boundary);
+        boundary += left;
+    }
+    
+    --boundary;
+    iter_swap(first, boundary);
+    return boundary;
+}
+
+template <typename RandomIt, typename Compare, typename Proj>
+void genericQuickSortLoop(RandomIt first, RandomIt last, int depthLimit, bool leftmost,
+                          Compare& comp, Proj& proj) {
+    ProjectedCompare<Compare, Proj> before{comp, proj};
+    
+    while (last - first > GENERIC_INSERTION_THRESHOLD) {
+        if (depthLimit-- == 0) {
+            heapSort(first, last, comp, proj);
+            return;
+        }
+        
+        // Median of three moved to *first
+        RandomIt mid = first + (last - first) / 2;
+        if (before(*mid, *(first + 1))) iter_swap(mid, first + 1);
+        if (before(*(last - 1), *(first + 1))) iter_swap(last - 1, first + 1);
+        if (before(*(last - 1), *mid)) iter_swap(last - 1, mid);
+        iter_swap(first, mid);
+        
+        RandomIt cut;
+        if constexpr (useBranchlessPartition<RandomIt, Compare, Proj>) {
+            // Pivot equal to the previous pivot: peel off all copies of it
+            if (!leftmost && !before(*(first - 1), *first)) {
+                first = partitionBranchless(first, last, [&](const auto& x) { return !before(*first, x); }) + 1;
+                continue;
+            }
+            cut = partitionBranchless(first, last, [&](const auto& x) { return before(x, *first); });
+        } else {
+            cut = partitionHoare(first, last, before);
+        }
+        
+        // Recurse into the smaller side, loop on the larger one
+        if (cut - first < last - cut) {
+            genericQuickSortLoop(first, cut, depthLimit, leftmost, comp, proj);
+            first = cut + 1;
+            leftmost = false;
+        } else {
+            genericQuickSortLoop(cut + 1, last, depthLimit, false, comp, proj);
+            last = cut;
+        }
+    }
+    
+    genericSmallSort(first, last, comp, proj);
+}
+
+// Introspective: median-of-three quick sort, heap sort past 2 log2(n) levels
+template <typename RandomIt, typename Compare = less<>, typename Proj = Identity>
+void quickSort(RandomIt first, RandomIt last, Compare comp = Compare(), Proj proj = Proj()) {
+    int depthLimit = 0;
+    for (auto n = last - first; n > 1; n >>= 1) depthLimit += 2;
+    
+    genericQuickSortLoop(first, last, depthLimit, true, comp, proj);
+}
+
+template <typename RandomIt, typename Compare = less<>, typename Proj = Identity>
+void quickSort3Way(RandomIt first, RandomIt last, Compare comp = Compare(), Proj proj = Proj()) {
+    ProjectedCompare<Compare, Proj> before{comp, proj};
+    
+    while (last - first > GENERIC_INSERTION_THRESHOLD) {
+        iter_swap(first, first + (last - first) / 2);
+        
+        // Dijkstra: [first, lt) < pivot, [lt, i) == pivot, (gt, last) > pivot
+        RandomIt lt = first, i = first + 1, gt = last - 1;
+        while (i <= gt) {
+            if (before(*i, *lt))
+                iter_swap(lt++, i++);
+            else if (before(*lt, *i))
+                iter_swap(i, gt--);
+            else
+                ++i;
+        }
+        
+        if (lt - first < last - gt) {
+            quickSort3Way(first, lt, comp, proj);
+            first = gt + 1;
+        } else {
+            quickSort3Way(gt + 1, last, comp, proj);
+            last = lt;
+        }
+    }
+    
+    genericSmallSort(first, last, comp, proj);
+}
+
+template <typename RandomIt, typename Compare = less<>, typename Proj = Identity>
+void shellSort(RandomIt first, RandomIt last, Compare comp = Compare(), Proj proj = Proj()) {
+    ProjectedCompare<Compare, Proj> before{comp, proj};
+    auto n = last - first;
+    
+    for (auto gap = n / 2; gap > 0; gap /= 2) {
+        for (auto i = gap; i < n; i++) {
+            auto temp = std::move(first[i]);
+            auto j = i;
+            
+            for (; j >= gap && before(temp, first[j - gap]); j -= gap)
+                first[j] = std::move(first[j - gap]);
+            
+            first[j] = std::move(temp);
+        }
+    }
+}
+
+template <typename RandomIt, typename Compare = less<>, typename Proj = Identity>
+void cocktailShakerSort(RandomIt first, RandomIt last, Compare comp = Compare(), Proj proj = Proj()) {
+    ProjectedCompare<Compare, Proj> before{comp, proj};
+    if (last - first <= 1) return;
+    
+    RandomIt start = first, end = last - 1;
+    bool swapped = true;
+    
+    while (swapped) {
+        swapped = false;
+        for (RandomIt i = start; i < end; ++i)
+            if (before(*(i + 1), *i)) { iter_swap(i, i + 1); swapped = true; }
+        
+        if (!swapped) break;
+        --end;
+        swapped = false;
+        
+        for (RandomIt i = end; i > start; --i)
+            if (before(*i, *(i - 1))) { iter_swap(i, i - 1); swapped = true; }
+        ++start;
+    }
+}
+
+template <typename RandomIt, typename Compare = less<>, typename Proj = Identity>
+void combSort(RandomIt first, RandomIt last, Compare comp = Compare(), Proj proj = Proj()) {
+    ProjectedCompare<Compare, Proj> before{comp, proj};
+    auto n = last - first;
+    auto gap = n;
+    bool swapped = true;
+    
+    while (gap > 1 || swapped) {
+        gap = max<decltype(gap)>(gap * 10 / 13, 1);
+        swapped = false;
+        
+        for (decltype(n) i = 0; i + gap < n; i++) {
+            if (before(first[i + gap], first[i])) {
+                iter_swap(first + i, first + i + gap);
+                swapped = true;
+            }
+        }
+    }
+}
+
+// Stable LSD radix sort on an integral key of any width (one pass per byte)
+template <typename RandomIt, typename Proj = Identity>
+void radixSort(RandomIt first, RandomIt last, Proj proj = Proj()) {
+    typedef typename iterator_traits<RandomIt>::value_type T;
+    typedef ProjectedKey<RandomIt, Proj> Key;
+    static_assert(isRadixKey<Key>, "radixSort needs an integral or floating-point key");
+    static_assert(is_default_constructible_v<T>, "radixSort needs a default-constructible element");
+    
+    const int PASSES = sizeof(Key);
+    size_t n = last - first;
+    if (n <= 1) return;
+    
+    auto digitOf = [&](const T& x, int pass) {
+        return (size_t)(radixKeyOf<Key>(invoke(proj, x)) >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1);
+    };
+    
+    // All histograms in one read pass
+    ScratchBuffer<size_t> count(PASSES * RADIX_BUCKETS, 0);
+    for (RandomIt it = first; it != last; ++it)
+        for (int pass = 0; pass < PASSES; pass++)
+            count[pass * RADIX_BUCKETS + digitOf(*it, pass)]++;
+    
+    ScratchBuffer<T> buffer(n);
+    bool inBuffer = false;
+    
+    for (int pass = 0; pass < PASSES; pass++) {
+        size_t* passCount = &count[pass * RADIX_BUCKETS];
+        if (passCount[inBuffer ? digitOf(buffer[0], pass) : digitOf(*first, pass)] == n) continue;
+        
+        size_t sum = 0;
+        for (int d = 0; d < RADIX_BUCKETS; d++) {
+            size_t c = passCount[d];
+            passCount[d] = sum;
+            sum += c;
+        }
+        
+        // Ping-pong between the range and the buffer
+        if (inBuffer) {
+            for (size_t i = 0; i < n; i++)
+                first[passCount[digitOf(buffer[i], pass)]++] = std::move(buffer[i]);
+        } else {
+            for (size_t i = 0; i < n; i++)
+                buffer[passCount[digitOf(first[i], pass)]++] = std::move(first[i]);
+        }
+        inBuffer = !inBuffer;
+    }
+    
+    if (inBuffer)
+        move(buffer.begin(), buffer.end(), first);
+}
+
+// Stable counting sort on an integral key; ranges much wider than the input
+// would waste memory on the histogram, so those go to radix sort instead
+template <typename RandomIt, typename Proj = Identity>
+void countingSort(RandomIt first, RandomIt last, Proj proj = Proj()) {
+    typedef typename iterator_traits<RandomIt>::value_type T;
+    typedef ProjectedKey<RandomIt, Proj> Key;
+    static_assert(isRadixKey<Key> && is_integral_v<Key>, "countingSort needs an integral key");
+    
+    size_t n = last - first;
+    if (n <= 1) return;
+    
+    auto keyOf = [&](const T& x) { return radixKeyOf<Key>(invoke(proj, x)); };
+    auto minKey = keyOf(*first), maxKey = minKey;
+    for (RandomIt it = first; it != last; ++it) {
+        minKey = min(minKey, keyOf(*it));
+        maxKey = max(maxKey, keyOf(*it));
+    }
+    
+    unsigned long long range = (unsigned long long)(maxKey - minKey) + 1;
+    if (range == 0 || range > max<unsigned long long>(2 * n, 1 << 16)) {
+        radixSort(first, last, proj);
+        return;
+    }
+    
+    ScratchBuffer<size_t> count(range + 1, 0);
+    for (RandomIt it = first; it != last; ++it)
+        count[keyOf(*it) - minKey + 1]++;
+    for (size_t k = 1; k <= range; k++)
+        count[k] += count[k - 1];
+    
+    ScratchBuffer<T> output(n);
+    for (RandomIt it = first; it != last; ++it)
+        output[count[keyOf(*it) - minKey]++] = std::move(*it);
+    
+    move(output.begin(), output.end(), first);
+}
+
+const int FAST_SORT_RADIX_MIN = 256; // Radix sort pays off above this size
+
+// Picks the fastest generic path at compile time: radix sort for integral
+// keys in natural order, introspective quick sort for everything else
+template <typename RandomIt, typename Compare = less<>, typename Proj = Identity>
+void fastSort(RandomIt first, RandomIt last, Compare comp = Compare(), Proj proj = Proj()) {
+    typedef ProjectedKey<RandomIt, Proj> Key;
+    typedef typename iterator_traits<RandomIt>::value_type T;
+    
+    if constexpr (isRadixKey<Key> && isNaturalOrder<Compare, Key> && is_default_constructible_v<T>) {
+        if (last - first >= FAST_SORT_RADIX_MIN) {
+            radixSort(first, last, proj);
+            return;
+        }
+    }
+    
+    quickSort(first, last, comp, proj);
+}
+
+// ==========================================================================
+// 18. LOSER TREE K-WAY MERGE - O(n log k) Time, O(k) Space
+// Tournament tree over k sorted inputs: one pass over the data and one
+// comparison per tree level per element, instead of log k two-way passes
+// ==========================================================================
+
+// Internal nodes remember the loser of their match, so replacing the winner
+// only replays the matches on its own leaf-to-root path. Ties go to the
+// lower source index, which keeps the merge stable.
+template <typename T, typename Compare = less<T>>
+class LoserTree {
+public:
+    explicit LoserTree(int k, Compare comp = Compare())
+        : k(k), leaves(leafCount(k)), comp(comp), head(leaves), exhausted(leaves, true), tree(leaves, -1) {}
+    
+    // Sets the first value of source i; sources never set start out empty
+    void setHead(int i, const T& value) {
+        head[i] = value;
+        exhausted[i] = false;
+    }
+    
+    // Plays the initial tournament bottom-up
+    void build() {
+        ScratchBuffer<int> winners(2 * leaves);
+        for (int i = 0; i < leaves; i++)
+            winners[leaves + i] = i;
+        
+        for (int node = leaves - 1; node >= 1; node--) {
+            int a = winners[2 * node], b = winners[2 * node + 1];
+            bool aWins = beats(a, b);
+            winners[node] = aWins ? a : b;
+            tree[node] = aWins ? b : a;
+        }
+        
+        tree[0] = winners[1];
+    }
+    
+    // Source holding the smallest head, or -1 once every source is empty
+    int winner() const {
+        return exhausted[tree[0]] ? -1 : tree[0];
+    }
+    
+    const T& top() const { return head[tree[0]]; }
+    
+    // The winner's source moved on to value
+    void replaceWinner(const T& value) {
+        head[tree[0]] = value;
+        replay();
+    }
+    
+    // The winner's source has run dry
+    void exhaustWinner() {
+        exhausted[tree[0]] = true;
+        replay();
+    }
+
+private:
+    static int leafCount(int k) {
+        int leaves = 1;
+        while (leaves < k) leaves *= 2;
+        return leaves;
+    }
+    
+    bool beats(int a, int b) const {
+        if (exhausted[a] || exhausted[b]) return !exhausted[a] && (exhausted[b] || a < b);
+        if (comp(head[a], head[b])) return true;
+        if (comp(head[b], head[a])) return false;
+        return a < b;
+    }
+    
+    void replay() {
+        int source = tree[0];
+        
+        for (int node = (leaves + source) / 2; node >= 1; node /= 2) {
+            if (beats(tree[node], source))
+                swap(tree[node], source);
+        }
+        
+        tree[0] = source;
+    }
+    
+    int k, leaves;
+    Compare comp;
+    ScratchBuffer<T> head;
+    ScratchBuffer<bool> exhausted;
+    ScratchBuffer<int> tree; // tree[0] = overall winner, tree[1..] = losers
+};
+
+template <typename T>
+using SortedRun = pair<const T*, const T*>;
+
+// Merges k sorted runs into out in a single pass; returns the end of the output
+template <typename T, typename Compare = less<T>>
+T* kWayMerge(const SortedRun<T>* runs, int k, T* out, Compare comp = Compare()) {
+    if (k == 0) return out;
+    
+    ScratchBuffer<const T*> cursor(k);
+    LoserTree<T, Compare> tree(k, comp);
+    
+    for (int i = 0; i < k; i++) {
+        cursor[i] = runs[i].first;
+        if (cursor[i] != runs[i].second) tree.setHead(i, *cursor[i]);
+    }
+    tree.build();
+    
+    for (int source = tree.winner(); source >= 0; source = tree.winner()) {
+        *out++ = tree.top();
+        
+        if (++cursor[source] != runs[source].second)
+            tree.replaceWinner(*cursor[source]);
+        else
+            tree.exhaustWinner();
+    }
+    
+    return out;
+}
+
+template <typename T, typename Compare = less<T>>
+T* kWayMerge(const vector<SortedRun<T>>& runs, T* out, Compare comp = Compare()) {
+    return kWayMerge(runs.data(), runs.size(), out, comp);
+}
+
+// Multi-sequence selection: splits[i] = how many elements of run i belong to
+// the first `rank` outputs of the stable merge. Each round probes the
+// weighted median of the middle elements of the still-open intervals, which
+// closes at least a quarter of the remaining elements, so it takes
+// O(log n) rounds of k binary searches.
+template <typename T, typename Compare = less<T>>
+void multiSequenceSelect(const vector<SortedRun<T>>& runs, size_t rank, size_t* splits, Compare comp = Compare()) {
+    int k = runs.size();
+    size_t* low = splits;
+    ScratchBuffer<size_t> high(k), below(k);
+    for (int i = 0; i < k; i++) {
+        low[i] = 0;
+        high[i] = runs[i].second - runs[i].first;
+    }
+    
+    // Stable merge order: by value, then by run index, then by position
+    auto before = [&](int runA, size_t posA, int runB, size_t posB) {
+        const T& a = runs[runA].first[posA];
+        const T& b = runs[runB].first[posB];
+        if (comp(a, b)) return true;
+        if (comp(b, a)) return false;
+        return runA != runB ? runA < runB : posA < posB;
+    };
+    
+    ScratchBuffer<pair<int, size_t>> candidates(k);
+    while (true) {
+        // Middle element of every open interval, weighted by its size
+        int open = 0;
+        size_t totalWeight = 0;
+        for (int i = 0; i < k; i++) {
+            if (low[i] < high[i]) {
+                candidates[open++] = {i, low[i] + (high[i] - low[i]) / 2};
+                totalWeight += high[i] - low[i];
+            }
+        }
+        if (open == 0) break;
+        
+        sort(candidates.begin(), candidates.begin() + open, [&](const pair<int, size_t>& a, const pair<int, size_t>& b) {
+            return before(a.first, a.second, b.first, b.second);
+        });
+        
+        size_t weight = 0;
+        int pivotRun = candidates[open - 1].first;
+        size_t pivotPos = candidates[open - 1].second;
+        for (int c = 0; c < open; c++) {
+            auto [run, pos] = candidates[c];
+            weight += high[run] - low[run];
+            if (2 * weight >= totalWeight) {
+                pivotRun = run;
+                pivotPos = pos;
+                break;
+            }
+        }
+        
+        // below[i] = elements of run i that come before the pivot. Everything
+        // left of an open interval precedes the pivot and everything right of
+        // it follows, so searching inside the interval is enough.
+        size_t pivotRank = 0;
+        for (int i = 0; i < k; i++) {
+            if (i == pivotRun) {
+                below[i] = pivotPos;
+            } else {
+                size_t lo = low[i], hi = high[i];
+                while (lo < hi) {
+                    size_t mid = lo + (hi - lo) / 2;
+                    if (before(i, mid, pivotRun, pivotPos)) lo = mid + 1;
+                    else hi = mid;
+                }
+                below[i] = lo;
+            }
+            pivotRank += below[i];
+        }
+        
+        if (pivotRank < rank) {
+            // The pivot and everything before it is selected
+            for (int i = 0; i < k; i++) low[i] = max(low[i], below[i]);
+            low[pivotRun] = pivotPos + 1;
+        } else {
+            for (int i = 0; i < k; i++) high[i] = min(high[i], below[i]);
+        }
+    }
+}
+
+template <typename T, typename Compare = less<T>>
+vector<size_t> multiSequenceSelect(const vector<SortedRun<T>>& runs, size_t rank, Compare comp = Compare()) {
+    vector<size_t> splits(runs.size());
+    multiSequenceSelect(runs, rank, splits.data(), comp);
+    return splits;
+}
+
+// Parallel k-way merge: multi-sequence selection cuts the output into one
+// equal slice per thread, and every slice is merged by its own loser tree
+template <typename T, typename Compare = less<T>>
+void parallelKWayMerge(const vector<SortedRun<T>>& runs, T* out, Compare comp = Compare()) {
+    int k = runs.size();
+    size_t total = 0;
+    for (const SortedRun<T>& run : runs)
+        total += run.second - run.first;
+    
+    int threads = sortThreadCount();
+    if (threads <= 1 || total < (size_t)PARALLEL_SORT_CUTOFF) {
+        kWayMerge(runs, out, comp);
+        return;
+    }
+    
+    // splits[t * k + i] = where slice t starts in run i
+    ScratchBuffer<size_t> splits((size_t)(threads + 1) * k);
+    runParallel(threads + 1, [&](int t) {
+        multiSequenceSelect(runs, total * t / threads, &splits[(size_t)t * k], comp);
+    });
+    
+    runParallel(threads, [&](int t) {
+        ScratchBuffer<SortedRun<T>> slice(k);
+        for (int i = 0; i < k; i++)
+            slice[i] = {runs[i].first + splits[(size_t)t * k + i], runs[i].first + splits[(size_t)(t + 1) * k + i]};
+        
+        kWayMerge(slice.data(), k, out + total * t / threads, comp);
+    });
+}
+
+// ==========================================================================
+// 19. ADAPTIVE MERGE SORT (POWERSORT) - O(n + n log r) Time, O(n) Space
+// Stable natural merge sort for nearly sorted data: finds the runs already
+// in the input, merges them in powersort order and gallops through long
+// stretches taken from one side. Sorted input costs one pass, r runs cost
+// O(n log r) instead of O(n log n).
+// ==========================================================================
+
+const int ADAPTIVE_MIN_RUN = 32;   // Shorter runs are extended by binary insertion
+const int ADAPTIVE_MIN_GALLOP = 7; // Consecutive wins from one side before galloping
+
+// Length of the run starting at first; a strictly descending run is reversed
+// in place (strictly, so that reversing it cannot reorder equal elements)
+template <typename RandomIt, typename Before>
+size_t countRunAndMakeAscending(RandomIt first, RandomIt last, Before& before) {
+    RandomIt runEnd = first + 1;
+    if (runEnd == last) return 1;
+    
+    if (before(*runEnd, *first)) {
+        while (runEnd != last && before(*runEnd, *(runEnd - 1))) ++runEnd;
+        reverse(first, runEnd);
+    } else {
+        while (runEnd != last && !before(*runEnd, *(runEnd - 1))) ++runEnd;
+    }
+    
+    return runEnd - first;
+}
+
+// Grows the sorted prefix [first, sortedEnd) to [first, last); upper_bound
+// puts each element after its equals, which keeps the sort stable
+template <typename RandomIt, typename Before>
+void binaryInsertionSort(RandomIt first, RandomIt sortedEnd, RandomIt last, Before& before) {
+    for (RandomIt it = sortedEnd; it != last; ++it) {
+        RandomIt pos = upper_bound(first, it, *it, before);
+        if (pos == it) continue;
+        
+        auto value = std::move(*it);
+        move_backward(pos, it, it + 1);
+        *pos = std::move(value);
+    }
+}
+
+// Number of leading elements of [first, first + n) that satisfy pred, for a
+// pred that holds on a prefix: exponential probe, then binary search, so a
+// short answer costs O(log answer) comparisons
+template <typename RandomIt, typename Pred>
+size_t gallopForward(RandomIt first, size_t n, Pred pred) {
+    size_t low = 0, high = 1;
+    while (high <= n && pred(first[high - 1])) {
+        low = high;
+        high = 2 * high + 1;
+    }
+    
+    high = min(high, n);
+    return partition_point(first + low, first + high, pred) - first;
+}
+
+// Number of trailing elements of [last - n, last) that satisfy pred, for a
+// pred that holds on a suffix
+template <typename RandomIt, typename Pred>
+size_t gallopBackward(RandomIt last, size_t n, Pred pred) {
+    size_t low = 0, high = 1;
+    while (high <= n && pred(*(last - high))) {
+        low = high;
+        high = 2 * high + 1;
+    }
+    
+    high = min(high, n);
+    return partition_point(make_reverse_iterator(last) + low, make_reverse_iterator(last) + high, pred) -
+           make_reverse_iterator(last);
+}
+
+// Merges runs [first, mid) and [mid, last) with the smaller one moved out to
+// buffer, which must have room for it. Elements are taken one at a time until one side wins
+// ADAPTIVE_MIN_GALLOP times in a row, then whole blocks are located by
+// galloping until both sides win only short blocks again.
+template <typename RandomIt, typename Before, typename T>
+void gallopingMerge(RandomIt first, RandomIt mid, RandomIt last, Before& before, T* buffer) {
+    // Elements of the left run not above the right run's head, and of the
+    // right run not below the left run's tail, are already in place
+    first += gallopForward(first, mid - first, [&](const auto& x) { return !before(*mid, x); });
+    if (first == mid) return;
+    last -= gallopBackward(last, last - mid, [&](const auto& x) { return !before(x, *(mid - 1)); });
+    
+    if (mid - first <= last - mid) {
+        // Left run is smaller: merge forward from the front
+        T* a = buffer;
+        T* aEnd = move(first, mid, buffer);
+        RandomIt b = mid, out = first;
+        
+        while (a != aEnd && b != last) {
+            int winsA = 0, winsB = 0;
+            while (a != aEnd && b != last && winsA < ADAPTIVE_MIN_GALLOP && winsB < ADAPTIVE_MIN_GALLOP) {
+                if (before(*b, *a)) {
+                    *out++ = std::move(*b++);
+                    winsB++;
+                    winsA = 0;
+                } else {
+                    *out++ = std::move(*a++);
+                    winsA++;
+                    winsB = 0;
+                }
+            }
+            
+            while (a != aEnd && b != last) {
+                size_t countA = gallopForward(a, aEnd - a, [&](const auto& x) { return !before(*b, x); });
+                out = move(a, a + countA, out);
+                a += countA;
+                if (a == aEnd) break;
+                
+                size_t countB = gallopForward(b, last - b, [&](const auto& y) { return before(y, *a); });
+                out = move(b, b + countB, out);
+                b += countB;
+                
+                if (countA < ADAPTIVE_MIN_GALLOP && countB < ADAPTIVE_MIN_GALLOP) break;
+            }
+        }
+        
+        move(a, aEnd, out);
+    } else {
+        // Right run is smaller: merge backward from the back
+        T* bBegin = buffer;
+        T* b = move(mid, last, buffer);
+        RandomIt a = mid, out = last;
+        
+        while (a != first && b != bBegin) {
+            int winsA = 0, winsB = 0;
+            while (a != first && b != bBegin && winsA < ADAPTIVE_MIN_GALLOP && winsB < ADAPTIVE_MIN_GALLOP) {
+                if (before(*(b - 1), *(a - 1))) {
+                    *--out = std::move(*--a);
+                    winsA++;
+                    winsB = 0;
+                } else {
+                    *--out = std::move(*--b);
+                    winsB++;
+                    winsA = 0;
+                }
+            }
+            
+            while (a != first && b != bBegin) {
+                size_t countB = gallopBackward(b, b - bBegin, [&](const auto& y) { return !before(y, *(a - 1)); });
+                out = move_backward(b - countB, b, out);
+                b -= countB;
+                if (b == bBegin) break;
+                
+                size_t countA = gallopBackward(a, a - first, [&](const auto& x) { return before(*(b - 1), x); });
+                out = move_backward(a - countA, a, out);
+                a -= countA;
+                
+                if (countA < ADAPTIVE_MIN_GALLOP && countB < ADAPTIVE_MIN_GALLOP) break;
+            }
+        }
+        
+        move_backward(bBegin, b, out);
+    }
+}
+
+// Powersort merge priority of the boundary between adjacent runs
+// [begin, mid) and [mid, end) of an n-element array: the depth of the first
+// bit where the two run midpoints, as fractions of n, differ
+inline int runBoundaryPower(size_t begin, size_t mid, size_t end, size_t n) {
+    // Both midpoints in units of 1 / (2n), so the arithmetic stays exact
+    uint64_t a = begin + mid, b = mid + end, twoN = 2 * (uint64_t)n;
+    int power = 0;
+    
+    while (true) {
+        power++;
+        a *= 2;
+        b *= 2;
+        if (a >= twoN) {
+            a -= twoN;
+            b -= twoN;
+        } else if (b >= twoN) {
+            return power;
+        }
+    }
+}
+
+template <typename RandomIt, typename Compare = less<>, typename Proj = Identity>
+void adaptiveMergeSort(RandomIt first, RandomIt last, Compare comp = Compare(), Proj proj = Proj()) {
+    ProjectedCompare<Compare, Proj> before{comp, proj};
+    size_t n = last - first;
+    if (n <= 1) return;
+    
+    // Next run, extended to ADAPTIVE_MIN_RUN elements when it is shorter
+    auto nextRun = [&](size_t begin) {
+        size_t end = begin + countRunAndMakeAscending(first + begin, last, before);
+        if (end - begin < (size_t)ADAPTIVE_MIN_RUN && end < n) {
+            size_t extended = min(n, begin + ADAPTIVE_MIN_RUN);
+            binaryInsertionSort(first + begin, first + end, first + extended, before);
+            end = extended;
+        }
+        return end;
+    };
+    
+    // Powers strictly increase towards the top, so at most one run per bit
+    // of n is pending. No merge moves out more than half of the elements.
+    struct Run { size_t begin, end; int power; };
+    Run pending[sizeof(size_t) * 8 + 1];
+    int pendingCount = 0;
+    ScratchBuffer<typename iterator_traits<RandomIt>::value_type> buffer(n / 2);
+    
+    size_t begin = 0, end = nextRun(0);
+    while (end < n) {
+        size_t nextEnd = nextRun(end);
+        int power = runBoundaryPower(begin, end, nextEnd, n);
+        
+        // Boundaries deeper in the power tree than the new one merge first
+        while (pendingCount > 0 && pending[pendingCount - 1].power > power) {
+            Run& top = pending[--pendingCount];
+            gallopingMerge(first + top.begin, first + begin, first + end, before, buffer.data());
+            begin = top.begin;
+        }
+        
+        pending[pendingCount++] = {begin, end, power};
+        begin = end;
+        end = nextEnd;
+    }
+    
+    while (pendingCount > 0) {
+        Run& top = pending[--pendingCount];
+        gallopingMerge(first + top.begin, first + begin, first + end, before, buffer.data());
+        begin = top.begin;
+    }
+}
+
+void adaptiveMergeSort(vector<int>& arr) {
+    adaptiveMergeSort(arr.begin(), arr.end());
+}
+
+// ==========================================================================
+// 20. AUTO SORT - Input-Aware Dispatch, O(n) Profiling + Chosen Algorithm
+// Profiles the input in one linear pass plus a small sample, then hands it
+// to whichever sort above fits: nothing for sorted input, adaptive merge for
+// few runs, counting sort for dense keys, radix sort for the rest
+// ==========================================================================
+
+const int AUTO_SORT_SAMPLE = 256;                 // Elements sampled for the duplicate ratio
+const int AUTO_SORT_RUN_DIVISOR = 64;             // Adaptive merge below n / 64 natural runs
+const long long AUTO_SORT_COUNTING_MAX = 1 << 16; // Counting array must stay cache-resident
+const int AUTO_SORT_FEW_DISTINCT_MAX = 1 << 12;   // Below this size, few keys favour pdqSort
+const double AUTO_SORT_FEW_DISTINCT_RATIO = 1.0 / 16;
+
+// What autoSort looks at before choosing
+struct SortProfile {
+    int n = 0;
+    int minKey = 0, maxKey = 0;
+    long long range = 0;           // maxKey - minKey + 1
+    int descents = 0, ascents = 0; // Adjacent pairs strictly out of / in order
+    double distinctRatio = 1;      // Distinct keys / keys in an evenly spaced sample
+};
+
+SortProfile profileInput(const vector<int>& arr) {
+    SortProfile profile;
+    profile.n = arr.size();
+    if (arr.empty()) return profile;
+    
+    // One branch-free pass: key range and adjacent order
+    int minKey = arr[0], maxKey = arr[0], descents = 0, ascents = 0;
+    for (int i = 1; i < profile.n; i++) {
+        minKey = min(minKey, arr[i]);
+        maxKey = max(maxKey, arr[i]);
+        descents += arr[i] < arr[i - 1];
+        ascents += arr[i] > arr[i - 1];
+    }
+    
+    profile.minKey = minKey;
+    profile.maxKey = maxKey;
+    profile.range = (long long)maxKey - minKey + 1;
+    profile.descents = descents;
+    profile.ascents = ascents;
+    
+    int sampleSize = min(profile.n, AUTO_SORT_SAMPLE);
+    ScratchBuffer<int> sample(sampleSize);
+    for (int i = 0; i < sampleSize; i++)
+        sample[i] = arr[(long long)i * profile.n / sampleSize];
+    sort(sample.begin(), sample.end());
+    profile.distinctRatio = (double)(unique(sample.begin(), sample.end()) - sample.begin()) / sampleSize;
+    
+    return profile;
+}
+
+// Sorts arr with the algorithm its profile favours; stats.decision receives
+// the algorithm's name and the reason it was picked
+template <typename Stats = NullStats>
+void autoSort(vector<int>& arr, Stats&& stats = Stats()) {
+    if ((int)arr.size() <= SORTING_NETWORK_MAX) {
+        stats.decision("sortingNetwork", "n <= 64");
+        if (!arr.empty()) sortSmallBlock(arr.data(), arr.size());
+        return;
+    }
+    
+    // Profiling would cost as much as sorting; pdqSort adapts to order anyway
+    if ((int)arr.size() < FAST_SORT_RADIX_MIN) {
+        stats.decision("pdqSort", "too small for radix histograms");
+        pdqSort(arr);
+        return;
+    }
+    
+    SortProfile profile = profileInput(arr);
+    int n = profile.n;
+    
+    if (profile.descents == 0) {
+        stats.decision("none", "already sorted");
+    } else if (profile.ascents == 0) {
+        stats.decision("reverse", "non-increasing input");
+        reverse(arr.begin(), arr.end());
+    } else if (profile.descents < n / AUTO_SORT_RUN_DIVISOR) {
+        stats.decision("adaptiveMergeSort", "few natural runs");
+        adaptiveMergeSort(arr);
+    } else if (profile.range <= n / 4 && profile.range <= AUTO_SORT_COUNTING_MAX) {
+        stats.decision("countingSort", "dense key range");
+        countingSort(arr);
+    } else if (n < AUTO_SORT_FEW_DISTINCT_MAX && profile.distinctRatio <= AUTO_SORT_FEW_DISTINCT_RATIO) {
+        stats.decision("pdqSort", "few distinct keys over a wide range");
+        pdqSort(arr);
+    } else if (n >= PARALLEL_SORT_CUTOFF && sortThreadCount() > 1) {
+        stats.decision("parallelRadixSort", "large input, several cores");
+        parallelRadixSort(arr);
+    } else {
+        stats.decision("radixSort", "wide integer keys");
+        radixSort(arr);
+    }
+}
+
+// ==========================================================================
+// 21. EXTERNAL MERGE SORT - O(n log n) CPU, O(n * passes) I/O
+// Sorts binary files of fixed-width integer keys that do not fit in RAM:
+// sorted runs from memory-budgeted chunks, then k-way merges of the run
+// files with large sequential reads and double-buffered background writes
+// ==========================================================================
+
+const size_t EXTERNAL_MIN_IO_BUFFER = 64 << 10; // Smallest buffer per file stream
+
+struct ExternalSortOptions {
+    size_t memoryBudget = 256 << 20; // Bytes of keys and buffers held at once
+    string tempDirectory;            // Where runs go; empty = system temp dir
+    int maxFanIn = 128;              // Most runs merged at once
+};
+
+struct ExternalSortStats {
+    long long keys = 0;
+    int runs = 0;
+    int mergePasses = 0;
+    long long bytesRead = 0;
+    long long bytesWritten = 0;
+};
+
+struct FileCloser {
+    void operator()(FILE* file) const { fclose(file); }
+};
+
+using FileHandle = unique_ptr<FILE, FileCloser>;
+
+// Removes every run file it was handed that is still on disk, so that an
+// exception part way through a sort leaves no temporaries behind
+struct RunFileGuard {
+    vector<string> created;
+    
+    ~RunFileGuard() {
+        error_code ignored;
+        for (const string& path : created)
+            filesystem::remove(path, ignored);
+    }
+};
+
+// Sequential reader over a run file with one large buffer
+template <typename Key>
+class RunReader {
+public:
+    RunReader(const string& path, size_t bufferKeys, long long& bytesRead)
+        : file(fopen(path.c_str(), "rb")), buffer(bufferKeys), bytesRead(bytesRead) {
+        if (!file) throw runtime_error("externalSort: cannot open " + path);
+    }
+    
+    RunReader(const RunReader&) = delete;
+    RunReader& operator=(const RunReader&) = delete;
+    
+    // Reads the next key; false once the run is exhausted
+    bool next(Key& key) {
+        if (pos == size && !refill()) return false;
+        key = buffer[pos++];
+        return true;
+    }
+
+private:
+    bool refill() {
+        size = fread(buffer.data(), sizeof(Key), buffer.size(), file.get());
+        if (ferror(file.get())) throw runtime_error("externalSort: read failed");
+        pos = 0;
+        bytesRead += size * sizeof(Key);
+        return size > 0;
+    }
+    
+    FileHandle file;
+    vector<Key> buffer;
+    size_t pos = 0, size = 0;
+    long long& bytesRead;
+};
+
+// Double-buffered writer: one buffer fills while the other is written out
+// on a background thread
+template <typename Key>
+class RunWriter {
+public:
+    RunWriter(const string& path, size_t bufferKeys, long long& bytesWritten)
+        : file(fopen(path.c_str(), "wb")), capacity(bufferKeys), bytesWritten(bytesWritten) {
+        if (!file) throw runtime_error("externalSort: cannot create " + path);
+        active.reserve(capacity);
+        inFlight.reserve(capacity);
+    }
+    
+    ~RunWriter() {
+        if (pending.valid()) pending.wait();
+    }
+    
+    RunWriter(const RunWriter&) = delete;
+    RunWriter& operator=(const RunWriter&) = delete;
+    
+    void push(Key key) {
+        active.push_back(key);
+        if (active.size() == capacity) flush();
+    }
+    
+    void write(const Key* keys, size_t count) {
+        for (size_t i = 0; i < count; i++)
+            push(keys[i]);
+    }
+    
+    // Writes everything still buffered and closes the file
+    void close() {
+        flush();
+        waitForWrite();
+        
+        if (fclose(file.release()) != 0) writeFailed = true;
+        
+        if (writeFailed) throw runtime_error("externalSort: write failed");
+    }
+
+private:
+    void flush() {
+        if (active.empty()) return;
+        
+        // The other buffer must be on disk before it can be reused
+        waitForWrite();
+        swap(active, inFlight);
+        bytesWritten += inFlight.size() * sizeof(Key);
+        
+        pending = async(launch::async, [this] {
+            if (fwrite(inFlight.data(), sizeof(Key), inFlight.size(), file.get()) != inFlight.size())
+                writeFailed = true;
+            inFlight.clear();
+        });
+    }
+    
+    void waitForWrite() {
+        if (pending.valid()) pending.get();
+        if (writeFailed) throw runtime_error("externalSort: write failed");
+    }
+    
+    FileHandle file;
+    size_t capacity;
+    vector<Key> active, inFlight;
+    future<void> pending;
+    bool writeFailed = false;
+    long long& bytesWritten;
+};
+
+// Merges sorted run files into one output file through a loser tree.
+// Ties go to the earlier run.
+template <typename Key>
+void mergeRunFiles(const vector<string>& inputs, const string& outputPath,
+                   size_t bufferKeys, ExternalSortStats& stats) {
+    int k = inputs.size();
+    LoserTree<Key> tree(k);
+    vector<unique_ptr<RunReader<Key>>> readers;
+    
+    for (int i = 0; i < k; i++) {
+        readers.push_back(make_unique<RunReader<Key>>(inputs[i], bufferKeys, stats.bytesRead));
+        
+        Key key;
+        if (readers[i]->next(key)) tree.setHead(i, key);
+    }
+    tree.build();
+    
+    RunWriter<Key> writer(outputPath, bufferKeys, stats.bytesWritten);
+    
+    for (int source = tree.winner(); source >= 0; source = tree.winner()) {
+        writer.push(tree.top());
+        
+        Key key;
+        if (readers[source]->next(key))
+            tree.replaceWinner(key);
+        else
+            tree.exhaustWinner();
+    }
+    
+    writer.close();
+}
+
+template <typename Key>
+ExternalSortStats externalSort(const string& inputPath, const string& outputPath,
+                               const ExternalSortOptions& options = ExternalSortOptions()) {
+    static_assert(is_integral_v<Key>, "externalSort sorts fixed-width integer keys");
+    
+    ExternalSortStats stats;
+    size_t budget = max(options.memoryBudget, 4 * EXTERNAL_MIN_IO_BUFFER);
+    
+    filesystem::path tempDir = options.tempDirectory.empty()
+        ? filesystem::temp_directory_path() : filesystem::path(options.tempDirectory);
+    string prefix = (tempDir / ("extsort-" + to_string(chrono::steady_clock::now().time_since_epoch().count()))).string();
+    int runCounter = 0;
+    RunFileGuard runFiles;
+    auto newRunPath = [&] {
+        runFiles.created.push_back(prefix + "-" + to_string(runCounter++) + ".run");
+        return runFiles.created.back();
+    };
+    
+    uintmax_t inputBytes = filesystem::file_size(inputPath);
+    if (inputBytes % sizeof(Key) != 0)
+        throw runtime_error("externalSort: input size is not a multiple of the key size");
+    
+    // Phase 1: sorted runs. The writer holds two I/O buffers and the
+    // in-memory sort needs a scratch copy of the chunk, so a chunk gets half
+    // of what the writer leaves over.
+    size_t ioKeys = max(EXTERNAL_MIN_IO_BUFFER, budget / 16) / sizeof(Key);
+    size_t chunkKeys = (budget - 2 * ioKeys * sizeof(Key)) / (2 * sizeof(Key));
+    
+    vector<string> runs;
+    FileHandle input(fopen(inputPath.c_str(), "rb"));
+    if (!input) throw runtime_error("externalSort: cannot open " + inputPath);
+    
+    vector<Key> chunk(chunkKeys);
+    while (true) {
+        chunk.resize(chunkKeys);
+        size_t got = fread(chunk.data(), sizeof(Key), chunkKeys, input.get());
+        if (ferror(input.get())) throw runtime_error("externalSort: cannot read " + inputPath);
+        if (got == 0) break;
+        
+        chunk.resize(got);
+        stats.keys += got;
+        stats.bytesRead += got * sizeof(Key);
+        
+        // Fastest in-memory sort available for the key type
+        if constexpr (is_same_v<Key, int>)
+            parallelRadixSort(chunk);
+        else
+            fastSort(chunk.begin(), chunk.end());
+        
+        runs.push_back(newRunPath());
+        RunWriter<Key> writer(runs.back(), ioKeys, stats.bytesWritten);
+        writer.write(chunk.data(), chunk.size());
+        writer.close();
+    }
+    input.reset();
+    vector<Key>().swap(chunk);
+    
+    stats.runs = runs.size();
+    
+    // Phase 2: k-way merge passes. Each input stream and the two output
+    // buffers share the budget, which caps the fan-in.
+    int fanIn = max(2, min<int>(options.maxFanIn, budget / EXTERNAL_MIN_IO_BUFFER - 2));
+    size_t mergeKeys = budget / (fanIn + 2) / sizeof(Key);
+    
+    while (runs.size() > 1) {
+        bool finalPass = (int)runs.size() <= fanIn;
+        vector<string> nextRuns;
+        
+        for (size_t g = 0; g < runs.size(); g += fanIn) {
+            vector<string> group(runs.begin() + g, runs.begin() + min(runs.size(), g + fanIn));
+            
+            // A lone leftover run waits for the next pass
+            if (group.size() == 1) {
+                nextRuns.push_back(group[0]);
+                continue;
+            }
+            
+            string merged = finalPass ? outputPath : newRunPath();
+            mergeRunFiles<Key>(group, merged, mergeKeys, stats);
+            
+            for (const string& run : group)
+                filesystem::remove(run);
+            nextRuns.push_back(merged);
+        }
+        
+        runs = nextRuns;
+        stats.mergePasses++;
+    }
+    
+    // Zero or one run: the output is the run itself (or empty)
+    if (runs.empty()) {
+        RunWriter<Key> empty(outputPath, 1, stats.bytesWritten);
+        empty.close();
+    } else if (runs[0] != outputPath) {
+        // Renaming costs no I/O; across file systems it fails and the run
+        // is copied instead
+        error_code renameFailed;
+        filesystem::rename(runs[0], outputPath, renameFailed);
+        if (renameFailed) {
+            filesystem::copy_file(runs[0], outputPath, filesystem::copy_options::overwrite_existing);
+            filesystem::remove(runs[0]);
+            stats.bytesWritten += stats.keys * sizeof(Key);
+        }
+    }
+    
+    return stats;
+}
+
+// ==========================================================================
+// 22. SELECTION - O(n) Time, O(log n) Space
+// nthElement puts the k-th smallest element at arr[k], smaller ones before
+// it and larger ones after, without sorting either side. Introselect on
+// the three-way partition: large ranges take a Floyd-Rivest pivot from a
+// sample around k, small ones a median of three, and after two lopsided
+// partitions in a row every pivot is a median of medians, which keeps the
+// worst case linear. partialSort and the streaming TopK build on it.
+// ==========================================================================
+
+const int FLOYD_RIVEST_CUTOFF = 600;  // Ranges this large sample their pivot
+const int SELECT_BAD_IN_A_ROW = 2;    // Lopsided partitions before median of medians
+
+template <typename Stats>
+void selectRange(vector<int>& arr, int low, int high, int k, Stats& stats);
+
+// Moves the median of each group of five to the front of the range and
+// selects the middle one of those; at least 3/10 of the range lies on
+// either side of it
+template <typename Stats>
+int medianOfMediansPivot(vector<int>& arr, int low, int high, Stats& stats) {
+    int medians = low;
+    
+    for (int group = low; group <= high; group += 5) {
+        int groupHigh = min(group + 4, high);
+        sortLeaf(arr, group, groupHigh, stats);
+        swap(arr[medians++], arr[group + (groupHigh - group) / 2]);
+        stats.swap();
+    }
+    
+    int mid = low + (medians - 1 - low) / 2;
+    selectRange(arr, low, medians - 1, mid, stats);
+    return mid;
+}
+
+// Floyd-Rivest: selects k within a sample of about n^(2/3) elements around
+// it, leaving arr[k] a pivot within a few sample gaps of the true answer.
+// The sample is gathered with a stride first, so sorted runs and other
+// patterns in the input do not skew it.
+template <typename Stats>
+int floydRivestPivot(vector<int>& arr, int low, int high, int k, Stats& stats) {
+    double n = high - low + 1;
+    double i = k - low + 1;
+    double z = log(n);
+    double s = 0.5 * exp(2 * z / 3);
+    double sd = 0.5 * sqrt(z * s * (n - s) / n) * (i < n / 2 ? -1 : 1);
+    
+    int sampleLow = max(low, (int)(k - i * s / n + sd));
+    int sampleHigh = min(high, (int)(k + (n - i) * s / n + sd));
+    
+    int sampleSize = sampleHigh - sampleLow + 1;
+    for (int j = 0; j < sampleSize; j++) {
+        swap(arr[sampleLow + j], arr[low + (int)((long long)j * (n - 1) / max(sampleSize - 1, 1))]);
+        stats.swap();
+    }
+    
+    selectRange(arr, sampleLow, sampleHigh, k, stats);
+    return k;
+}
+
+template <typename Stats>
+void selectRange(vector<int>& arr, int low, int high, int k, Stats& stats) {
+    // Partitions keeping more than 3/4 of the range are bad. While no two
+    // come in a row, every other partition shrinks the range by 3/4 and the
+    // total work stays within 8n; past that, medians of medians keep at most
+    // about 7/10 each time, so the switch is final.
+    int badInARow = 0;
+    
+    while (high - low >= SORTING_NETWORK_MAX) {
+        int size = high - low + 1;
+        int pivot;
+        if (badInARow >= SELECT_BAD_IN_A_ROW)
+            pivot = medianOfMediansPivot(arr, low, high, stats);
+        else if (size >= FLOYD_RIVEST_CUTOFF)
+            pivot = floydRivestPivot(arr, low, high, k, stats);
+        else
+            pivot = medianOfThree(arr, low, high, stats);
+        
+        swap(arr[low], arr[pivot]);
+        stats.swap();
+        
+        // Keys equal to the pivot land in [lt, gt], already in place
+        int lt, gt;
+        threeWayPartition(arr, low, high, lt, gt, stats);
+        if (k < lt)
+            high = lt - 1;
+        else if (k > gt)
+            low = gt + 1;
+        else
+            return;
+        
+        if (high - low + 1 > size / 4 * 3)
+            badInARow++;
+        else if (badInARow < SELECT_BAD_IN_A_ROW)
+            badInARow = 0;
+    }
+    
+    if (low < high) sortLeaf(arr, low, high, stats);
+}
+
+// Out-of-range k leaves arr unchanged
+template <typename Stats = NullStats>
+void nthElement(vector<int>& arr, int k, Stats&& stats = Stats()) {
+    if (k < 0 || k >= (int)arr.size()) return;
+    selectRange(arr, 0, arr.size() - 1, k, stats);
+}
+
+// Sorts the k smallest elements into arr[0..k-1]; the others follow in no
+// particular order. O(n + k log k) instead of O(n log n).
+template <typename Stats = NullStats>
+void partialSort(vector<int>& arr, int k, Stats&& stats = Stats()) {
+    int n = arr.size();
+    k = min(k, n);
+    if (k <= 0) return;
+    
+    // With arr[k - 1] selected, only the elements before it need sorting
+    int sortHigh = n - 1;
+    if (k < n) {
+        selectRange(arr, 0, n - 1, k - 1, stats);
+        sortHigh = k - 2;
+    }
+    
+    if (decay_t<Stats>::enabled)
+        heapSortRange(arr, 0, sortHigh, stats);
+    else
+        pdqSortRange(arr, 0, sortHigh);
+}
+
+// Streaming top-k: the k largest elements under Compare seen so far, kept
+// in a k-element heap whose top is the smallest of them. Input of any
+// length costs O(n log k) time and O(k) memory.
+template <typename T, typename Compare = less<T>>
+class TopK {
+public:
+    explicit TopK(size_t k, Compare comp = Compare()) : k(k), comp(comp), heap(Reversed{comp}) {
+        heap.reserve(k);
+    }
+    
+    void push(const T& value) {
+        if (heap.size() < k)
+            heap.push(value);
+        else if (k > 0 && comp(heap.top(), value))
+            heap.replaceTop(value);
+    }
+    
+    size_t size() const { return heap.size(); }
+    
+    // The kept elements, largest first
+    vector<T> sorted() const {
+        vector<T> result;
+        result.reserve(heap.size());
+        
+        auto rest = heap;
+        while (!rest.empty()) {
+            result.push_back(rest.top());
+            rest.pop();
+        }
+        
+        reverse(result.begin(), result.end());
+        return result;
+    }
+
+private:
+    struct Reversed {
+        Compare comp;
+        bool operator()(const T& a, const T& b) const { return comp(b, a); }
+    };
+    
+    size_t k;
+    Compare comp;
+    DaryHeap<T, heapArity<T>, Reversed> heap;
+};
+
+// Top k of a single pass over [first, last), largest first; works on input
+// iterators such as istream_iterator that cannot be rewound
+template <typename InputIt, typename Compare = less<>>
+vector<typename iterator_traits<InputIt>::value_type> topK(InputIt first, InputIt last, size_t k,
+                                                           Compare comp = Compare()) {
+    TopK<typename iterator_traits<InputIt>::value_type, Compare> best(k, comp);
+    for (; first != last; ++first) best.push(*first);
+    return best.sorted();
+}
+
+// ==========================================================================
+// 23. KEY/PAYLOAD SORTING - Structure of Arrays, argsort, permutations
+// Records split into a vector<int> of keys and a vector<Payload> of the
+// rest, sorted together: only the keys are compared and the payloads
+// follow every key move. Payloads wider than PAYLOAD_INDIRECT_BYTES are
+// not dragged through each pass; the keys are sorted with row indices
+// instead and every payload is moved once at the end, in place by
+// applyPermutation for the in-place quick sort, through a buffer by
+// gatherPermutation for the sorts that already use O(n) space.
+// ==========================================================================
+
+const size_t PAYLOAD_INDIRECT_BYTES = 16;
+const int KEYED_INSERTION_THRESHOLD = 24; // Runs this short use insertion sort
+
+// Rearranges values so that values[i] becomes the old values[order[i]],
+// following each cycle of the permutation once: every element is moved a
+// single time, plus one temporary per cycle. Cycles are marked by flipping
+// the bits of order's entries, which are restored before returning.
+template <typename T>
+void applyPermutation(T* values, int* order, int n) {
+    for (int leader = 0; leader < n; leader++) {
+        if (order[leader] < 0) continue;
+        
+        T carried = std::move(values[leader]);
+        int hole = leader;
+        
+        while (order[hole] != leader) {
+            int next = order[hole];
+            values[hole] = std::move(values[next]);
+            order[hole] = ~next;
+            hole = next;
+        }
+        
+        values[hole] = std::move(carried);
+        order[hole] = ~leader;
+    }
+    
+    for (int i = 0; i < n; i++)
+        order[i] = ~order[i];
+}
+
+template <typename T>
+void applyPermutation(vector<T>& values, vector<int>& order) {
+    applyPermutation(values.data(), order.data(), order.size());
+}
+
+// Same result as applyPermutation through a second array: O(n) extra
+// space, but the reads are independent of each other, so their cache
+// misses overlap instead of queueing along a cycle
+template <typename T>
+void gatherPermutation(T* values, const int* order, int n) {
+    ScratchBuffer<T> gathered(n);
+    for (int i = 0; i < n; i++)
+        gathered[i] = std::move(values[order[i]]);
+    move(gathered.begin(), gathered.end(), values);
+}
+
+template <typename T>
+void gatherPermutation(vector<T>& values, const vector<int>& order) {
+    gatherPermutation(values.data(), order.data(), order.size());
+}
+
+template <typename Payload>
+void checkKeyedSizes(const vector<int>& keys, const vector<Payload>& values) {
+    if (keys.size() != values.size()) throw invalid_argument("sortByKey: keys and values differ in length");
+}
+
+// Stable LSD radix sort of keys[0..n), values moving with them
+template <typename Payload>
+void radixSortByKey(int* keys, Payload* values, int n) {
+    if (n <= 1) return;
+    
+    if constexpr (sizeof(Payload) > PAYLOAD_INDIRECT_BYTES) {
+        ScratchBuffer<int> order(n);
+        iota(order.begin(), order.end(), 0);
+        radixSortByKey(keys, order.data(), n);
+        gatherPermutation(values, order.data(), n);
+    } else {
+        ScratchBuffer<int> count(RADIX_PASSES * RADIX_BUCKETS, 0);
+        radixHistograms(keys, n, count.data());
+        
+        ScratchBuffer<int> keyBuffer(n);
+        ScratchBuffer<Payload> valueBuffer(n);
+        int* keySrc = keys;
+        int* keyDst = keyBuffer.data();
+        Payload* valueSrc = values;
+        Payload* valueDst = valueBuffer.data();
+        
+        for (int pass = 0; pass < RADIX_PASSES; pass++) {
+            int shift = pass * RADIX_BITS;
+            int* passCount = &count[pass * RADIX_BUCKETS];
+            
+            unsigned firstDigit = (radixKey(keySrc[0]) >> shift) & (RADIX_BUCKETS - 1);
+            if (passCount[firstDigit] == n) continue;
+            
+            int sum = 0;
+            for (int d = 0; d < RADIX_BUCKETS; d++) {
+                int c = passCount[d];
+                passCount[d] = sum;
+                sum += c;
+            }
+            
+            for (int i = 0; i < n; i++) {
+                int at = passCount[(radixKey(keySrc[i]) >> shift) & (RADIX_BUCKETS - 1)]++;
+                keyDst[at] = keySrc[i];
+                valueDst[at] = std::move(valueSrc[i]);
+            }
+            
+            swap(keySrc, keyDst);
+            swap(valueSrc, valueDst);
+        }
+        
+        if (keySrc != keys) {
+            copy(keySrc, keySrc + n, keys);
+            move(valueSrc, valueSrc + n, values);
+        }
+    }
+}
+
+template <typename Payload>
+void radixSortByKey(vector<int>& keys, vector<Payload>& values) {
+    checkKeyedSizes(keys, values);
+    radixSortByKey(keys.data(), values.data(), keys.size());
+}
+
+// Stable insertion sort of keys[low..high) with their values
+template <typename Payload>
+void insertionSortByKey(int* keys, Payload* values, int low, int high) {
+    for (int i = low + 1; i < high; i++) {
+        int key = keys[i];
+        if (!(key < keys[i - 1])) continue;
+        
+        Payload value = std::move(values[i]);
+        int j = i;
+        
+        while (j > low && key < keys[j - 1]) {
+            keys[j] = keys[j - 1];
+            values[j] = std::move(values[j - 1]);
+            j--;
+        }
+        
+        keys[j] = key;
+        values[j] = std::move(value);
+    }
+}
+
+// Stable bottom-up merge sort: insertion-sorted runs, then merge passes that
+// alternate between the arrays and a buffer pair
+template <typename Payload>
+void mergeSortByKey(int* keys, Payload* values, int n) {
+    if (n <= 1) return;
+    
+    if constexpr (sizeof(Payload) > PAYLOAD_INDIRECT_BYTES) {
+        ScratchBuffer<int> order(n);
+        iota(order.begin(), order.end(), 0);
+        mergeSortByKey(keys, order.data(), n);
+        gatherPermutation(values, order.data(), n);
+    } else {
+        for (int low = 0; low < n; low += KEYED_INSERTION_THRESHOLD)
+            insertionSortByKey(keys, values, low, min(low + KEYED_INSERTION_THRESHOLD, n));
+        
+        ScratchBuffer<int> keyBuffer(n);
+        ScratchBuffer<Payload> valueBuffer(n);
+        int* keySrc = keys;
+        int* keyDst = keyBuffer.data();
+        Payload* valueSrc = values;
+        Payload* valueDst = valueBuffer.data();
+        
+        for (int width = KEYED_INSERTION_THRESHOLD; width < n; width *= 2) {
+            for (int low = 0; low < n; low += 2 * width) {
+                int mid = min(low + width, n), high = min(low + 2 * width, n);
+                int i = low, j = mid, out = low;
+                
+                // Ties take the left run first
+                while (i < mid && j < high) {
+                    int from = keySrc[j] < keySrc[i] ? j++ : i++;
+                    keyDst[out] = keySrc[from];
+                    valueDst[out++] = std::move(valueSrc[from]);
+                }
+                for (; i < mid; i++, out++) {
+                    keyDst[out] = keySrc[i];
+                    valueDst[out] = std::move(valueSrc[i]);
+                }
+                for (; j < high; j++, out++) {
+                    keyDst[out] = keySrc[j];
+                    valueDst[out] = std::move(valueSrc[j]);
+                }
+            }
+            
+            swap(keySrc, keyDst);
+            swap(valueSrc, valueDst);
+        }
+        
+        if (keySrc != keys) {
+            copy(keySrc, keySrc + n, keys);
+            move(valueSrc, valueSrc + n, values);
+        }
+    }
+}
+
+template <typename Payload>
+void mergeSortByKey(vector<int>& keys, vector<Payload>& values) {
+    checkKeyedSizes(keys, values);
+    mergeSortByKey(keys.data(), values.data(), keys.size());
+}
+
+template <typename Payload>
+void quickSortByKeyHelper(int* keys, Payload* values, int low, int high, int badAllowed) {
+    auto exchange = [&](int a, int b) {
+        swap(keys[a], keys[b]);
+        swap(values[a], values[b]);
+    };
+    
+    while (high - low > KEYED_INSERTION_THRESHOLD) {
+        // Median of three moved to keys[low]
+        int mid = low + (high - low) / 2;
+        if (keys[mid] < keys[low]) exchange(mid, low);
+        if (keys[high - 1] < keys[low]) exchange(high - 1, low);
+        if (keys[high - 1] < keys[mid]) exchange(high - 1, mid);
+        exchange(low, mid);
+        
+        // Hoare partition; equal keys stop both scans so duplicates split evenly
+        int pivot = keys[low];
+        int i = low, j = high;
+        while (true) {
+            do i++; while (i < high && keys[i] < pivot);
+            do j--; while (pivot < keys[j]);
+            if (i >= j) break;
+            exchange(i, j);
+        }
+        exchange(low, j);
+        
+        // Lopsided too often: radix sort the range in O(n)
+        int size = high - low;
+        if ((j - low < size / 8 || high - j - 1 < size / 8) && --badAllowed == 0) {
+            radixSortByKey(keys + low, values + low, size);
+            return;
+        }
+        
+        // Recurse into the smaller side
+        if (j - low < high - j - 1) {
+            quickSortByKeyHelper(keys, values, low, j, badAllowed);
+            low = j + 1;
+        } else {
+            quickSortByKeyHelper(keys, values, j + 1, high, badAllowed);
+            high = j;
+        }
+    }
+    
+    insertionSortByKey(keys, values, low, high);
+}
+
+// In-place, not stable
+template <typename Payload>
+void quickSortByKey(vector<int>& keys, vector<Payload>& values) {
+    checkKeyedSizes(keys, values);
+    int n = keys.size();
+    if (n <= 1) return;
+    
+    int badAllowed = 1;
+    for (int m = n; m >>= 1;) badAllowed++;
+    
+    if constexpr (sizeof(Payload) > PAYLOAD_INDIRECT_BYTES) {
+        ScratchBuffer<int> order(n);
+        iota(order.begin(), order.end(), 0);
+        quickSortByKeyHelper(keys.data(), order.data(), 0, n, badAllowed);
+        applyPermutation(values.data(), order.data(), n);
+    } else {
+        quickSortByKeyHelper(keys.data(), values.data(), 0, n, badAllowed);
+    }
+}
+
+// Stable sorting permutation: keys[order[0]] <= keys[order[1]] <= ...
+vector<int> argsort(const vector<int>& keys) {
+    ScratchBuffer<int> sortedKeys(keys.begin(), keys.end());
+    vector<int> order(keys.size());
+    iota(order.begin(), order.end(), 0);
+    radixSortByKey(sortedKeys.data(), order.data(), keys.size());
+    return order;
+}
+
+// Stable sorting permutation of any range, ordered by comp on proj(element)
+template <typename RandomIt, typename Compare = less<>, typename Proj = Identity>
+vector<int> argsort(RandomIt first, RandomIt last, Compare comp = Compare(), Proj proj = Proj()) {
+    vector<int> order(last - first);
+    iota(order.begin(), order.end(), 0);
+    mergeSort(order.begin(), order.end(), comp, [&](int i) -> decltype(auto) { return invoke(proj, first[i]); });
+    return order;
+}
+
+// ==========================================================================
+// 24. BLOCK MERGE SORT (GRAILSORT) - O(n log n) Time, O(1) Space, Stable
+// Stable merge sort without an O(n) buffer. It first gathers about 2 sqrt(n)
+// distinct values to the front of the array: one half tags the blocks of
+// each merge so equal blocks keep their order, the other half is the swap
+// buffer that merges rotate through (its contents move around but are never
+// lost). Runs are merged by sorting sqrt(n)-sized blocks by their first
+// element and then merging neighbouring blocks locally. At the end the keys
+// are sorted and merged back in place. Inputs with fewer distinct values
+// fall back to smaller buffers or rotation merges. An optional cache of
+// BLOCK_MERGE_CACHE elements replaces swaps with plain moves in the early
+// passes.
+// ==========================================================================
+
+const int BLOCK_MERGE_CACHE = 512;
+
+template <typename T>
+void grailSwapRanges(T* a, T* b, int count) {
+    for (int i = 0; i < count; i++)
+        swap(a[i], b[i]);
+}
+
+// Exchanges the adjacent ranges a[0..len1) and a[len1..len1 + len2)
+template <typename T>
+void grailRotate(T* a, int len1, int len2) {
+    while (len1 && len2) {
+        if (len1 <= len2) {
+            grailSwapRanges(a, a + len1, len1);
+            a += len1;
+            len2 -= len1;
+        } else {
+            grailSwapRanges(a + (len1 - len2), a + len1, len2);
+            len1 -= len2;
+        }
+    }
+}
+
+// First position in arr[0..len) whose element is not before key
+template <typename T, typename Before>
+int grailLowerBound(T* arr, int len, const T& key, Before& before) {
+    int low = 0, high = len;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (before(arr[mid], key))
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+// First position in arr[0..len) whose element is after key
+template <typename T, typename Before>
+int grailUpperBound(T* arr, int len, const T& key, Before& before) {
+    int low = 0, high = len;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (before(key, arr[mid]))
+            high = mid;
+        else
+            low = mid + 1;
+    }
+    return low;
+}
+
+template <typename T, typename Before>
+void grailInsertionSort(T* arr, int len, Before& before) {
+    for (int i = 1; i < len; i++)
+        for (int j = i - 1; j >= 0 && before(arr[j + 1], arr[j]); j--)
+            swap(arr[j], arr[j + 1]);
+}
+
+// Stably collects up to wanted distinct values, sorted, at the front of arr;
+// returns how many it found
+template <typename T, typename Before>
+int grailFindKeys(T* arr, int len, int wanted, Before& before) {
+    int found = 1, keysStart = 0;
+    
+    for (int u = 1; u < len && found < wanted; u++) {
+        int at = grailLowerBound(arr + keysStart, found, arr[u], before);
+        if (at == found || before(arr[u], arr[keysStart + at])) {
+            // Slide the keys up to u, then insert arr[u] among them
+            grailRotate(arr + keysStart, found, u - (keysStart + found));
+            keysStart = u - found;
+            grailRotate(arr + keysStart + at, found - at, 1);
+            found++;
+        }
+    }
+    
+    grailRotate(arr, keysStart, found);
+    return found;
+}
+
+// Merges arr[0..len1) and arr[len1..len1 + len2) by rotations:
+// O(min(len1, len2)^2 + max(len1, len2))
+template <typename T, typename Before>
+void grailMergeWithoutBuffer(T* arr, int len1, int len2, Before& before) {
+    if (len1 < len2) {
+        while (len1) {
+            int h = grailLowerBound(arr + len1, len2, arr[0], before);
+            if (h != 0) {
+                grailRotate(arr, len1, h);
+                arr += h;
+                len2 -= h;
+            }
+            if (len2 == 0) break;
+            
+            do {
+                arr++;
+                len1--;
+            } while (len1 && !before(arr[len1], arr[0]));
+        }
+    } else {
+        while (len2) {
+            int h = grailUpperBound(arr, len1, arr[len1 + len2 - 1], before);
+            if (h != len1) {
+                grailRotate(arr + h, len1 - h, len2);
+                len1 = h;
+            }
+            if (len1 == 0) break;
+            
+            do {
+                len2--;
+            } while (len2 && !before(arr[len1 + len2 - 1], arr[len1 - 1]));
+        }
+    }
+}
+
+// Merges arr[0..len1) and arr[len1..len1 + len2) into arr[to..], swapping
+// with the buffer that starts there (to < 0)
+template <typename T, typename Before>
+void grailMergeLeft(T* arr, int len1, int len2, int to, Before& before) {
+    int left = 0, right = len1;
+    len2 += len1;
+    
+    while (right < len2) {
+        if (left == len1 || before(arr[right], arr[left]))
+            swap(arr[to++], arr[right++]);
+        else
+            swap(arr[to++], arr[left++]);
+    }
+    
+    if (to != left) grailSwapRanges(arr + to, arr + left, len1 - left);
+}
+
+// Mirror image of grailMergeLeft: the buffer arr[len1 + len2 .. + to) follows
+template <typename T, typename Before>
+void grailMergeRight(T* arr, int len1, int len2, int to, Before& before) {
+    int out = len1 + len2 + to - 1, right = len1 + len2 - 1, left = len1 - 1;
+    
+    while (left >= 0) {
+        if (right < len1 || before(arr[right], arr[left]))
+            swap(arr[out--], arr[left--]);
+        else
+            swap(arr[out--], arr[right--]);
+    }
+    
+    if (right != out)
+        while (right >= len1) swap(arr[out--], arr[right--]);
+}
+
+// Same as grailMergeLeft with free space instead of a buffer before arr
+template <typename T, typename Before>
+void grailMergeLeftWithCache(T* arr, int len1, int len2, int to, Before& before) {
+    int left = 0, right = len1;
+    len2 += len1;
+    
+    while (right < len2) {
+        if (left == len1 || before(arr[right], arr[left]))
+            arr[to++] = std::move(arr[right++]);
+        else
+            arr[to++] = std::move(arr[left++]);
+    }
+    
+    if (to != left)
+        while (left < len1) arr[to++] = std::move(arr[left++]);
+}
+
+// Block-merge steps. A run of length *len1 carries the origin *origin (0:
+// left run, 1: right run); it is merged with the next block of length len2
+// into the bufferLen elements before arr. What is left of the side that did not
+// run out stays behind, with its length and origin written back.
+template <typename T, typename Before>
+void grailSmartMergeWithBuffer(T* arr, int* len1, int* origin, int len2, int bufferLen, Before& before) {
+    int out = -bufferLen, left = 0, right = *len1, leftEnd = right, rightEnd = right + len2;
+    int otherOrigin = 1 - *origin;
+    
+    // Ties go to the left run, which is the first stream when origin is 0
+    while (left < leftEnd && right < rightEnd) {
+        bool takeLeft = otherOrigin ? !before(arr[right], arr[left]) : before(arr[left], arr[right]);
+        if (takeLeft)
+            swap(arr[out++], arr[left++]);
+        else
+            swap(arr[out++], arr[right++]);
+    }
+    
+    if (left < leftEnd) {
+        *len1 = leftEnd - left;
+        while (left < leftEnd) swap(arr[--leftEnd], arr[--rightEnd]);
+    } else {
+        *len1 = rightEnd - right;
+        *origin = otherOrigin;
+    }
+}
+
+template <typename T, typename Before>
+void grailSmartMergeWithCache(T* arr, int* len1, int* origin, int len2, int bufferLen, Before& before) {
+    int out = -bufferLen, left = 0, right = *len1, leftEnd = right, rightEnd = right + len2;
+    int otherOrigin = 1 - *origin;
+    
+    while (left < leftEnd && right < rightEnd) {
+        bool takeLeft = otherOrigin ? !before(arr[right], arr[left]) : before(arr[left], arr[right]);
+        if (takeLeft)
+            arr[out++] = std::move(arr[left++]);
+        else
+            arr[out++] = std::move(arr[right++]);
+    }
+    
+    if (left < leftEnd) {
+        *len1 = leftEnd - left;
+        while (left < leftEnd) arr[--rightEnd] = std::move(arr[--leftEnd]);
+    } else {
+        *len1 = rightEnd - right;
+        *origin = otherOrigin;
+    }
+}
+
+template <typename T, typename Before>
+void grailSmartMergeWithoutBuffer(T* arr, int* len1, int* origin, int len2Initial, Before& before) {
+    if (!len2Initial) return;
+    
+    int len1Left = *len1, len2 = len2Initial;
+    int otherOrigin = 1 - *origin;
+    
+    // Must l, from the rest, be placed after r, from the new block?
+    auto leftAfter = [&](const T& l, const T& r) { return otherOrigin ? before(r, l) : !before(l, r); };
+    
+    if (len1Left && leftAfter(arr[len1Left - 1], arr[len1Left])) {
+        while (len1Left) {
+            int h = otherOrigin ? grailLowerBound(arr + len1Left, len2, arr[0], before)
+                                : grailUpperBound(arr + len1Left, len2, arr[0], before);
+            if (h != 0) {
+                grailRotate(arr, len1Left, h);
+                arr += h;
+                len2 -= h;
+            }
+            if (len2 == 0) {
+                *len1 = len1Left;
+                return;
+            }
+            
+            do {
+                arr++;
+                len1Left--;
+            } while (len1Left && !leftAfter(arr[0], arr[len1Left]));
+        }
+    }
+    
+    *len1 = len2;
+    *origin = otherOrigin;
+}
+
+// Builds sorted runs of 2 * bufferLen from arr[0..len), using the
+// bufferLen elements before arr as the buffer; afterwards the buffer is the
+// first bufferLen elements and the runs follow it
+template <typename T, typename Before>
+void grailBuildBlocks(T* arr, int len, int bufferLen, T* cache, int cacheLen, Before& before) {
+    int cached = min(bufferLen, cacheLen);
+    while (cached & (cached - 1)) cached &= cached - 1;
+    
+    int h;
+    if (cached) {
+        // The cache holds the buffer's contents, so merges can move freely
+        move(arr - cached, arr, cache);
+        for (int m = 1; m < len; m += 2) {
+            int u = before(arr[m], arr[m - 1]);
+            arr[m - 3] = std::move(arr[m - 1 + u]);
+            arr[m - 2] = std::move(arr[m - u]);
+        }
+        if (len % 2) arr[len - 3] = std::move(arr[len - 1]);
+        arr -= 2;
+        
+        for (h = 2; h < cached; h *= 2) {
+            int p = 0;
+            for (; p <= len - 2 * h; p += 2 * h)
+                grailMergeLeftWithCache(arr + p, h, h, -h, before);
+            
+            int rest = len - p;
+            if (rest > h)
+                grailMergeLeftWithCache(arr + p, h, rest - h, -h, before);
+            else
+                for (; p < len; p++) arr[p - h] = std::move(arr[p]);
+            arr -= h;
+        }
+        
+        move(cache, cache + cached, arr + len);
+    } else {
+        for (int m = 1; m < len; m += 2) {
+            int u = before(arr[m], arr[m - 1]);
+            swap(arr[m - 3], arr[m - 1 + u]);
+            swap(arr[m - 2], arr[m - u]);
+        }
+        if (len % 2) swap(arr[len - 1], arr[len - 3]);
+        arr -= 2;
+        h = 2;
+    }
+    
+    for (; h < bufferLen; h *= 2) {
+        int p = 0;
+        for (; p <= len - 2 * h; p += 2 * h)
+            grailMergeLeft(arr + p, h, h, -h, before);
+        
+        int rest = len - p;
+        if (rest > h)
+            grailMergeLeft(arr + p, h, rest - h, -h, before);
+        else
+            grailRotate(arr + p - h, h, rest);
+        arr -= h;
+    }
+    
+    // The buffer is now at the end: merge right to left to bring it back
+    int restLen = len % (2 * bufferLen);
+    int p = len - restLen;
+    if (restLen <= bufferLen)
+        grailRotate(arr + p, restLen, bufferLen);
+    else
+        grailMergeRight(arr + p, bufferLen, restLen - bufferLen, bufferLen, before);
+    
+    while (p > 0) {
+        p -= 2 * bufferLen;
+        grailMergeRight(arr + p, bufferLen, bufferLen, bufferLen, before);
+    }
+}
+
+// Merges blocks after the selection sort in grailCombineBlocks. keys tag
+// the blocks in order, those before *midKey came from the left run.
+// nblocks2 more left-run blocks and a short right-run tail of lastLen
+// elements follow the sorted blocks.
+template <typename T, typename Before>
+void grailMergeBuffersLeft(T* keys, T* midKey, T* arr, int blockCount, int blockLen, bool haveBuffer,
+                           int blockCount2, int lastLen, bool useCache, Before& before) {
+    if (blockCount == 0) {
+        int l = blockCount2 * blockLen;
+        if (useCache)
+            grailMergeLeftWithCache(arr, l, lastLen, -blockLen, before);
+        else if (haveBuffer)
+            grailMergeLeft(arr, l, lastLen, -blockLen, before);
+        else
+            grailMergeWithoutBuffer(arr, l, lastLen, before);
+        return;
+    }
+    
+    // Moves a finished stretch into the buffer gap before it
+    auto shiftDown = [&](int from, int count) {
+        if (useCache)
+            move(arr + from, arr + from + count, arr + from - blockLen);
+        else if (haveBuffer)
+            grailSwapRanges(arr + from - blockLen, arr + from, count);
+    };
+    
+    int restLen = blockLen;
+    int restOrigin = before(keys[0], *midKey) ? 0 : 1;
+    int blockStart = blockLen;
+    
+    for (int block = 1; block < blockCount; block++, blockStart += blockLen) {
+        int restStart = blockStart - restLen;
+        int nextOrigin = before(keys[block], *midKey) ? 0 : 1;
+        
+        if (nextOrigin == restOrigin) {
+            shiftDown(restStart, restLen);
+            restLen = blockLen;
+        } else if (useCache) {
+            grailSmartMergeWithCache(arr + restStart, &restLen, &restOrigin, blockLen, blockLen, before);
+        } else if (haveBuffer) {
+            grailSmartMergeWithBuffer(arr + restStart, &restLen, &restOrigin, blockLen, blockLen, before);
+        } else {
+            grailSmartMergeWithoutBuffer(arr + restStart, &restLen, &restOrigin, blockLen, before);
+        }
+    }
+    
+    int restStart = blockStart - restLen;
+    if (lastLen) {
+        if (restOrigin) {
+            shiftDown(restStart, restLen);
+            restStart = blockStart;
+            restLen = blockLen * blockCount2;
+        } else {
+            restLen += blockLen * blockCount2;
+        }
+        
+        if (useCache)
+            grailMergeLeftWithCache(arr + restStart, restLen, lastLen, -blockLen, before);
+        else if (haveBuffer)
+            grailMergeLeft(arr + restStart, restLen, lastLen, -blockLen, before);
+        else
+            grailMergeWithoutBuffer(arr + restStart, restLen, lastLen, before);
+    } else {
+        shiftDown(restStart, restLen);
+    }
+}
+
+// Merges neighbouring runs of runLen in arr[0..len) pairwise, in blocks of
+// blockLen tagged by the keys at the front of the array
+template <typename T, typename Before>
+void grailCombineBlocks(T* keys, T* arr, int len, int runLen, int blockLen, bool haveBuffer, T* cache,
+                        Before& before) {
+    int pairs = len / (2 * runLen);
+    int restLen = len % (2 * runLen);
+    if (restLen <= runLen) {
+        len -= restLen;
+        restLen = 0;
+    }
+    
+    if (cache) move(arr - blockLen, arr, cache);
+    
+    for (int b = 0; b <= pairs; b++) {
+        if (b == pairs && restLen == 0) break;
+        
+        T* pair = arr + b * 2 * runLen;
+        int blockCount = (b == pairs ? restLen : 2 * runLen) / blockLen;
+        grailInsertionSort(keys, blockCount + (b == pairs ? 1 : 0), before);
+        
+        // Selection sort of the blocks by first element, ties by key
+        int midKey = runLen / blockLen;
+        for (int u = 1; u < blockCount; u++) {
+            int least = u - 1;
+            for (int v = u; v < blockCount; v++) {
+                if (before(pair[v * blockLen], pair[least * blockLen]) ||
+                    (!before(pair[least * blockLen], pair[v * blockLen]) && before(keys[v], keys[least])))
+                    least = v;
+            }
+            
+            if (least != u - 1) {
+                grailSwapRanges(pair + (u - 1) * blockLen, pair + least * blockLen, blockLen);
+                swap(keys[u - 1], keys[least]);
+                if (midKey == u - 1 || midKey == least) midKey ^= (u - 1) ^ least;
+            }
+        }
+        
+        int blockCount2 = 0, lastLen = 0;
+        if (b == pairs) lastLen = restLen % blockLen;
+        if (lastLen != 0)
+            while (blockCount2 < blockCount &&
+                   before(pair[blockCount * blockLen], pair[(blockCount - blockCount2 - 1) * blockLen]))
+                blockCount2++;
+        
+        grailMergeBuffersLeft(keys, keys + midKey, pair, blockCount - blockCount2, blockLen, haveBuffer,
+                              blockCount2, lastLen, cache != nullptr, before);
+    }
+    
+    // The buffer drifted to the end: shift everything back behind it
+    if (cache) {
+        for (int p = len; --p >= 0;) arr[p] = std::move(arr[p - blockLen]);
+        move(cache, cache + blockLen, arr - blockLen);
+    } else if (haveBuffer) {
+        while (--len >= 0) swap(arr[len], arr[len - blockLen]);
+    }
+}
+
+// Fewer than four distinct values: bottom-up merge sort by rotations
+template <typename T, typename Before>
+void grailLazyStableSort(T* arr, int len, Before& before) {
+    for (int m = 1; m < len; m += 2)
+        if (before(arr[m], arr[m - 1])) swap(arr[m - 1], arr[m]);
+    
+    for (int h = 2; h < len; h *= 2) {
+        int p = 0;
+        for (; p <= len - 2 * h; p += 2 * h)
+            grailMergeWithoutBuffer(arr + p, h, h, before);
+        
+        int rest = len - p;
+        if (rest > h) grailMergeWithoutBuffer(arr + p, h, rest - h, before);
+    }
+}
+
+template <typename T, typename Before>
+void grailSort(T* arr, int len, T* cache, int cacheLen, Before& before) {
+    if (len < 16) {
+        grailInsertionSort(arr, len, before);
+        return;
+    }
+    
+    int blockLen = 1;
+    while (blockLen * blockLen < len) blockLen *= 2;
+    int keyCount = (len - 1) / blockLen + 1;
+    int keysFound = grailFindKeys(arr, len, keyCount + blockLen, before);
+    
+    bool haveBuffer = true;
+    if (keysFound < keyCount + blockLen) {
+        if (keysFound < 4) {
+            grailLazyStableSort(arr, len, before);
+            return;
+        }
+        
+        // Too few distinct values for keys and buffer: keys only
+        keyCount = blockLen;
+        while (keyCount > keysFound) keyCount /= 2;
+        haveBuffer = false;
+        blockLen = 0;
+    }
+    
+    int start = blockLen + keyCount;
+    int runLen = haveBuffer ? blockLen : keyCount;
+    grailBuildBlocks(arr + start, len - start, runLen, haveBuffer ? cache : nullptr, haveBuffer ? cacheLen : 0,
+                     before);
+    
+    // Runs of 2 * runLen are sorted; keep doubling
+    while (len - start > (runLen *= 2)) {
+        int mergeBlockLen = blockLen;
+        bool mergeHasBuffer = haveBuffer;
+        
+        if (!haveBuffer) {
+            if (keyCount > 4 && keyCount / 8 * keyCount >= runLen) {
+                mergeBlockLen = keyCount / 2;
+                mergeHasBuffer = true;
+            } else {
+                int tags = 1;
+                long long s = (long long)runLen * keysFound / 2;
+                while (tags < keyCount && s != 0) {
+                    tags *= 2;
+                    s /= 8;
+                }
+                mergeBlockLen = (2 * runLen) / tags;
+            }
+        }
+        
+        bool cached = mergeHasBuffer && mergeBlockLen <= cacheLen;
+        grailCombineBlocks(arr, arr + start, len - start, runLen, mergeBlockLen, mergeHasBuffer,
+                           cached ? cache : nullptr, before);
+    }
+    
+    // Put the keys and the buffer back among the sorted rest
+    grailInsertionSort(arr, start, before);
+    grailMergeWithoutBuffer(arr, start, len - start, before);
+}
+
+// Stable, in place; useCache adds a 2 KB stack cache for the early passes
+void blockMergeSort(vector<int>& arr, bool useCache = true) {
+    int cache[BLOCK_MERGE_CACHE];
+    auto before = [](int a, int b) { return a < b; };
+    grailSort(arr.data(), (int)arr.size(), useCache ? cache : nullptr, useCache ? BLOCK_MERGE_CACHE : 0, before);
+}
+
+// Generic version for contiguous ranges; the cache is used when T is default constructible
+template <typename RandomIt, typename Compare = less<>, typename Proj = Identity>
+void blockMergeSort(RandomIt first, RandomIt last, Compare comp = Compare(), Proj proj = Proj()) {
+    using T = typename iterator_traits<RandomIt>::value_type;
+    static_assert(isContiguousIterator<RandomIt>,
+                  "blockMergeSort needs a T* or vector<T>::iterator range; use adaptiveMergeSort for others");
+    ProjectedCompare<Compare, Proj> before{comp, proj};
+    int n = last - first;
+    if (n <= 1) return;
+    
+    if constexpr (is_default_constructible_v<T>) {
+        ScratchBuffer<T> cache(min(n, BLOCK_MERGE_CACHE));
+        grailSort(&*first, n, cache.data(), (int)cache.size(), before);
+    } else {
+        grailSort(&*first, n, (T*)nullptr, 0, before);
+    }
+}
+
+// ==========================================================================
+// 25. INCREMENTAL SORT - O(m log m + m log n) Comparisons per Batch of m
+// For a sorted array that keeps receiving appends: a watermark records how
+// far the array is known to be sorted, and each call sorts only the new
+// tail and merges it into the prefix. Tails up to INCREMENTAL_SMALL_TAIL
+// are sorted by the network and merged backward, one binary search per
+// tail element; longer ones go through fastSort (radix for ints) and the
+// galloping merge of section 19. Either way each prefix element that has
+// to make room moves once, by one block move.
+// ==========================================================================
+
+const int INCREMENTAL_SMALL_TAIL = SORTING_NETWORK_MAX;
+
+// arr[0..sortedUpTo) must already be sorted. Sorts arr and returns
+// the new watermark, arr.size(), to pass to the next call.
+size_t incrementalSort(vector<int>& arr, size_t sortedUpTo) {
+    size_t n = arr.size();
+    size_t sorted = min(sortedUpTo, n); // The array may have shrunk since
+    size_t m = n - sorted;
+    if (m == 0) return n;
+    
+    int* data = arr.data();
+    if (m <= (size_t)INCREMENTAL_SMALL_TAIL)
+        sortSmallBlock(data + sorted, m);
+    else
+        fastSort(data + sorted, data + n);
+    
+    // Appended in order, or nothing to merge into
+    if (sorted == 0 || data[sorted - 1] <= data[sorted]) return n;
+    
+    if (m <= (size_t)INCREMENTAL_SMALL_TAIL) {
+        // Backward merge: the largest tail element finds its slot, the prefix
+        // elements above it shift up to their final place, and so on down
+        int tail[INCREMENTAL_SMALL_TAIL];
+        copy(data + sorted, data + n, tail);
+        
+        int* prefixEnd = data + sorted;
+        int* out = data + n;
+        int k = (int)m - 1;
+        for (; k >= 0 && prefixEnd != data; k--) {
+            int* slot = upper_bound(data, prefixEnd, tail[k]);
+            out = move_backward(slot, prefixEnd, out);
+            *--out = tail[k];
+            prefixEnd = slot;
+        }
+        
+        // Tail elements below the whole prefix
+        copy(tail, tail + k + 1, data);
+    } else {
+        auto before = [](int a, int b) { return a < b; };
+        ScratchBuffer<int> buffer(min(sorted, m));
+        gallopingMerge(data, data + sorted, data + n, before, buffer.data());
+    }
+    
+    return n;
+}
+
+// ==========================================================================
+// 26. STRING SORTING - Multikey Quick Sort and MSD Radix over string_view
+// Sorts views in place without touching the characters they point to, in
+// byte order (memcmp, shorter prefix first). Comparison sorts compare every
+// shared prefix again at every level; these never look at a byte twice
+// below the depth where its group was split off:
+// - Multikey quick sort: three-way partition (as in 5E) on the byte at the
+//   current depth; only the equal part moves on to the next byte.
+// - MSD radix: large groups cache their next 8 bytes as one big-endian
+//   uint64, sort by it with the LSD radix of section 17 (bytes common to
+//   the whole group cost a histogram pass, nothing more) and split into
+//   equal-key groups that continue 8 bytes deeper. Small groups go to
+//   multikey quick sort.
+// ==========================================================================
+
+const int MULTIKEY_INSERTION_MAX = 16;   // Insertion sort below this
+const size_t MSD_RADIX_MIN = 1 << 10;   // Smaller groups use multikey quick sort
+const size_t STRING_PREFIX_BYTES = sizeof(uint64_t);
+
+// Byte at depth plus one, or 0 past the end: ended strings sort first
+inline int charAt(string_view s, size_t depth) {
+    return depth < s.size() ? (unsigned char)s[depth] + 1 : 0;
+}
+
+// Bytes [depth, depth + 8) of s, zero padded, as a number in byte order
+inline uint64_t stringPrefixAt(string_view s, size_t depth) {
+    unsigned char bytes[STRING_PREFIX_BYTES] = {};
+    if (depth < s.size())
+        memcpy(bytes, s.data() + depth, min(STRING_PREFIX_BYTES, s.size() - depth));
+    
+    uint64_t key = 0;
+    for (unsigned char b : bytes)
+        key = key << 8 | b;
+    return key;
+}
+
+// Insertion sort of strings that agree on their first depth bytes
+void stringInsertionSort(string_view* a, size_t n, size_t depth) {
+    for (size_t i = 1; i < n; i++) {
+        string_view s = a[i];
+        string_view suffix = s.substr(min(depth, s.size()));
+        size_t j = i;
+        
+        for (; j > 0 && suffix < a[j - 1].substr(min(depth, a[j - 1].size())); j--)
+            a[j] = a[j - 1];
+        a[j] = s;
+    }
+}
+
+// Sorts a[0..n), whose strings agree on their first depth bytes
+void multikeyQuickSortRange(string_view* a, size_t n, size_t depth) {
+    while (n > (size_t)MULTIKEY_INSERTION_MAX) {
+        // Median of three bytes moved to a[0]
+        size_t mid = n / 2;
+        int first = charAt(a[0], depth), middle = charAt(a[mid], depth), last = charAt(a[n - 1], depth);
+        if ((first < middle) == (middle < last))
+            swap(a[0], a[mid]);
+        else if ((first < last) == (last < middle))
+            swap(a[0], a[n - 1]);
+        
+        // a[0..lt) below the pivot byte, a[lt..gt] equal, a(gt..n) above
+        int pivot = charAt(a[0], depth);
+        size_t lt = 0, i = 1, gt = n - 1;
+        while (i <= gt) {
+            int c = charAt(a[i], depth);
+            if (c < pivot)
+                swap(a[lt++], a[i++]);
+            else if (c > pivot)
+                swap(a[i], a[gt--]);
+            else
+                i++;
+        }
+        
+        multikeyQuickSortRange(a, lt, depth);
+        multikeyQuickSortRange(a + gt + 1, n - gt - 1, depth);
+        if (pivot == 0) return; // The equal part ended here: all the same string
+        
+        a += lt;
+        n = gt + 1 - lt;
+        depth++;
+    }
+    
+    stringInsertionSort(a, n, depth);
+}
+
+// Sorts a[0..n), whose strings agree on their first depth bytes
+void msdRadixSortRange(string_view* a, size_t n, size_t depth) {
+    while (n >= MSD_RADIX_MIN) {
+        // The sorted prefixes stay for the group scan, so every string is
+        // read once per level. Recursion only enters groups no larger than
+        // half the range, which bounds the prefixes alive at once by 2n.
+        ScratchBuffer<uint64_t> prefixes(n);
+        {
+            struct Cached {
+                uint64_t prefix;
+                string_view s;
+            };
+            
+            ScratchBuffer<Cached> cached(n);
+            for (size_t i = 0; i < n; i++) cached[i] = {stringPrefixAt(a[i], depth), a[i]};
+            radixSort(cached.begin(), cached.end(), &Cached::prefix);
+            for (size_t i = 0; i < n; i++) {
+                a[i] = cached[i].s;
+                prefixes[i] = cached[i].prefix;
+            }
+        }
         
-        if (!swapped) break;
+        // Groups of equal prefixes. Zero padding makes "ab" and "ab\0" look
+        // alike, so each group puts the strings that end within the 8 bytes
+        // first, shortest first, and only the rest goes 8 bytes deeper.
+        size_t deeper = depth + STRING_PREFIX_BYTES;
+        size_t groupStart = 0, tailStart = 0, tailEnd = 0; // Tail: largest group so far
         
-        end--;
-        swapped = false;
+        for (size_t i = 1; i <= n; i++) {
+            if (i < n && prefixes[i] == prefixes[groupStart]) continue;
+            
+            string_view* group = a + groupStart;
+            size_t size = i - groupStart;
+            string_view* longer = partition(group, group + size, [&](string_view s) { return s.size() <= deeper; });
+            sort(group, longer, [](string_view x, string_view y) { return x.size() < y.size(); });
+            
+            // The largest group continues in this loop instead of recursing
+            size_t longerStart = longer - a;
+            if (i - longerStart > tailEnd - tailStart) {
+                msdRadixSortRange(a + tailStart, tailEnd - tailStart, deeper);
+                tailStart = longerStart;
+                tailEnd = i;
+            } else {
+                msdRadixSortRange(a + longerStart, i - longerStart, deeper);
+            }
+            
+            groupStart = i;
+        }
         
-        // Backward pass
-        for (int i = end; i > start; i--) {
-            if (arr[i] < arr[i - 1]) {
-                swap(arr[i], arr[i - 1]);
-                swapped = true;
+        a += tailStart;
+        n = tailEnd - tailStart;
+        depth = deeper;
+    }
+    
+    multikeyQuickSortRange(a, n, depth);
+}
+
+void multikeyQuickSort(vector<string_view>& strs) {
+    multikeyQuickSortRange(strs.data(), strs.size(), 0);
+}
+
+void msdRadixSort(vector<string_view>& strs) {
+    msdRadixSortRange(strs.data(), strs.size(), 0);
+}
+
+// ==========================================================================
+// 27. MULTI-COLUMN ORDER BY - Normalized Keys, O(n * key bytes) Encoding
+// Sorts the rows of a columnar batch by several columns at once without a
+// multi-field comparator. Each row's sort columns are encoded into one
+// fixed-width byte key whose memcmp order is the ORDER BY order:
+// - Sign bit flipped for integers, floatRadixKey bits for doubles (-0.0
+//   equals 0.0, NaN above every number), raw bytes for string prefixes,
+//   all big-endian.
+// - Descending columns have their bytes inverted.
+// - Nullable columns get a leading byte that puts NULLs first or last in
+//   either direction; all NULLs of a column tie.
+// Keys are kept as big-endian 64-bit words. The rows are radix sorted by
+// their first word and only rows that tie on it are compared word by word.
+// The result is a stable permutation: ties keep their row order.
+// ==========================================================================
+
+enum class SortDirection { Ascending, Descending };
+enum class NullOrder { First, Last };
+
+// One ORDER BY column. Refers to the caller's vectors, which must outlive it.
+struct SortColumn {
+    enum class Type { Int32, Int64, Double, Bytes };
+    
+    Type type;
+    const void* values;
+    size_t rows;
+    size_t prefixBytes = 0; // Bytes: compared on this many leading bytes
+    SortDirection direction;
+    const vector<bool>* isNull = nullptr;
+    NullOrder nullOrder = NullOrder::Last;
+    
+    SortColumn(const vector<int>& v, SortDirection d = SortDirection::Ascending)
+        : type(Type::Int32), values(v.data()), rows(v.size()), direction(d) {}
+    SortColumn(const vector<int64_t>& v, SortDirection d = SortDirection::Ascending)
+        : type(Type::Int64), values(v.data()), rows(v.size()), direction(d) {}
+    SortColumn(const vector<double>& v, SortDirection d = SortDirection::Ascending)
+        : type(Type::Double), values(v.data()), rows(v.size()), direction(d) {}
+    
+    // Strings equal on their first prefix bytes tie (zero padded when shorter)
+    SortColumn(const vector<string_view>& v, size_t prefix, SortDirection d = SortDirection::Ascending)
+        : type(Type::Bytes), values(v.data()), rows(v.size()), prefixBytes(prefix), direction(d) {}
+    
+    SortColumn& withNulls(const vector<bool>& nulls, NullOrder order = NullOrder::Last) {
+        isNull = &nulls;
+        nullOrder = order;
+        return *this;
+    }
+    
+    size_t valueBytes() const {
+        switch (type) {
+        case Type::Int32: return 4;
+        case Type::Int64: return 8;
+        case Type::Double: return 8;
+        default: return prefixBytes;
+        }
+    }
+    
+    size_t keyBytes() const { return valueBytes() + (isNull ? 1 : 0); }
+    
+    // Writes the key bytes of row to out (keyBytes() of them)
+    void encode(size_t row, unsigned char* out) const {
+        if (isNull) {
+            bool null = (*isNull)[row];
+            *out++ = null == (nullOrder == NullOrder::Last);
+            if (null) {
+                fill(out, out + valueBytes(), 0);
+                return;
             }
         }
         
-        start++;
+        auto bigEndian = [&](uint64_t bits, int bytes) {
+            for (int b = bytes - 1; b >= 0; b--) {
+                out[b] = (unsigned char)bits;
+                bits >>= 8;
+            }
+        };
+        
+        switch (type) {
+        case Type::Int32:
+            bigEndian(radixKey(((const int*)values)[row]), 4);
+            break;
+        case Type::Int64:
+            bigEndian((uint64_t)((const int64_t*)values)[row] ^ (uint64_t(1) << 63), 8);
+            break;
+        case Type::Double:
+            bigEndian(floatRadixKey(((const double*)values)[row]), 8);
+            break;
+        case Type::Bytes: {
+            string_view s = ((const string_view*)values)[row];
+            size_t copied = min(prefixBytes, s.size());
+            memcpy(out, s.data(), copied);
+            fill(out + copied, out + prefixBytes, 0);
+            break;
+        }
+        }
+        
+        if (direction == SortDirection::Descending)
+            for (size_t b = 0; b < valueBytes(); b++) out[b] = ~out[b];
+    }
+};
+
+// Rows in ORDER BY order: row order[0] first. Apply to every column of the
+// batch with gatherPermutation or applyPermutation.
+vector<int> orderBy(const vector<SortColumn>& columns) {
+    size_t n = columns.empty() ? 0 : columns[0].rows;
+    size_t keyBytes = 0;
+    for (const SortColumn& column : columns) {
+        if (column.rows != n) throw invalid_argument("orderBy: columns differ in length");
+        if (column.isNull && column.isNull->size() != n)
+            throw invalid_argument("orderBy: NULL mask and column differ in length");
+        keyBytes += column.keyBytes();
+    }
+    
+    vector<int> order(n);
+    iota(order.begin(), order.end(), 0);
+    if (n <= 1 || keyBytes == 0) return order;
+    
+    // Row-major keys, a column at a time, then each word made big-endian
+    // so that comparing words as integers compares the bytes
+    size_t words = (keyBytes + 7) / 8;
+    ScratchBuffer<uint64_t> keys(n * words, 0);
+    size_t offset = 0;
+    for (const SortColumn& column : columns) {
+        for (size_t row = 0; row < n; row++)
+            column.encode(row, (unsigned char*)&keys[row * words] + offset);
+        offset += column.keyBytes();
+    }
+    
+    for (uint64_t& word : keys) {
+        unsigned char bytes[8];
+        memcpy(bytes, &word, 8);
+        word = 0;
+        for (unsigned char b : bytes) word = word << 8 | b;
+    }
+    
+    // Stable LSD radix on the first word
+    struct Head {
+        uint64_t word;
+        int row;
+    };
+    {
+        ScratchBuffer<Head> heads(n);
+        for (size_t row = 0; row < n; row++) heads[row] = {keys[row * words], (int)row};
+        radixSort(heads.begin(), heads.end(), &Head::word);
+        for (size_t i = 0; i < n; i++) order[i] = heads[i].row;
+    }
+    if (words == 1) return order;
+    
+    // Rows tied on the first word: the remaining words, then row order
+    auto before = [&](int a, int b) {
+        const uint64_t* x = &keys[(size_t)a * words];
+        const uint64_t* y = &keys[(size_t)b * words];
+        for (size_t w = 1; w < words; w++)
+            if (x[w] != y[w]) return x[w] < y[w];
+        return a < b;
+    };
+    
+    for (size_t start = 0, end; start < n; start = end) {
+        uint64_t first = keys[(size_t)order[start] * words];
+        for (end = start + 1; end < n && keys[(size_t)order[end] * words] == first; end++) {}
+        if (end - start > 1) sort(order.begin() + start, order.begin() + end, before);
     }
+    
+    return order;
 }
 
 // ==========================================================================
-// 12. COMB SORT - O(n log n) Average, O(n²) Worst, O(1) Space
-// Improved bubble sort with shrinking gap
+// 28. BENCHMARK SUITE - ./sorting --bench [options]
+// Times every vector<int> sort over seeded input distributions and sizes
+// (1e2 to 1e8 by default), against std::sort and std::stable_sort, and
+// reports ns/element, throughput and peak heap use. The float, double and
+// int64 radix and sample sorts run on the same inputs converted to their
+// type (conversion untimed); their speedups are still against std::sort of
+// the ints. Results can also be written as JSON:
+//   --sizes=1e2,1e4,1e6  --distributions=uniform,zipf  --algorithms=pdqSort
+//   --seed=42  --json=results.json  --huge-pages
 // ==========================================================================
 
-void combSort(vector<int>& arr) {
-    int n = arr.size();
-    int gap = n;
-    bool swapped = true;
+// Heap bytes live and high-water mark, kept by the global operator new below
+atomic<size_t> heapBytesInUse{0};
+atomic<size_t> heapBytesPeak{0};
+
+// Each block carries its size in a header padded to keep max_align_t alignment.
+// Kept out of line so the compiler does not pair the inlined free() with new.
+const size_t HEAP_HEADER = alignof(max_align_t);
+
+[[gnu::noinline]] void* trackedAllocate(size_t size) {
+    char* block = (char*)malloc(size + HEAP_HEADER);
+    if (!block) return nullptr;
     
-    while (gap != 1 || swapped) {
-        // Find next gap
-        gap = (gap * 10) / 13;
-        if (gap < 1) gap = 1;
+    *(size_t*)block = size;
+    size_t inUse = heapBytesInUse.fetch_add(size, memory_order_relaxed) + size;
+    size_t peak = heapBytesPeak.load(memory_order_relaxed);
+    while (inUse > peak && !heapBytesPeak.compare_exchange_weak(peak, inUse, memory_order_relaxed)) {}
+    
+    return block + HEAP_HEADER;
+}
+
+[[gnu::noinline]] void trackedFree(void* ptr) {
+    if (!ptr) return;
+    
+    char* block = (char*)ptr - HEAP_HEADER;
+    heapBytesInUse.fetch_sub(*(size_t*)block, memory_order_relaxed);
+    free(block);
+}
+
+void* operator new(size_t size) {
+    void* ptr = trackedAllocate(size ? size : 1);
+    if (!ptr) throw bad_alloc();
+    return ptr;
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+void* operator new(size_t size, const nothrow_t&) noexcept { return trackedAllocate(size ? size : 1); }
+void* operator new[](size_t size, const nothrow_t&) noexcept { return trackedAllocate(size ? size : 1); }
+void operator delete(void* ptr) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr) noexcept { trackedFree(ptr); }
+void operator delete(void* ptr, size_t) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { trackedFree(ptr); }
+void operator delete(void* ptr, const nothrow_t&) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr, const nothrow_t&) noexcept { trackedFree(ptr); }
+
+const size_t BENCH_QUADRATIC_MAX = 10000; // Largest input given to an O(n²) case
+const double BENCH_MIN_SECONDS = 0.2;      // Repeat small inputs until this much time
+const int BENCH_MAX_REPS = 1000;
+
+struct BenchResult {
+    double nsPerElement;
+    size_t peakBytes; // Heap allocated by the sort beyond its input
+    int reps;
+    bool correct;
+};
+
+// Measures a sort of another element type on (input, expected) converted
+using TypedBench = function<BenchResult(const vector<int>& input, const vector<int>& expected)>;
+
+struct BenchAlgorithm {
+    string name;
+    function<void(vector<int>&)> sort; // Empty for typed entries
+    size_t maxSize;                    // Largest input worth timing at all
+    vector<string> quadraticOn;        // Distributions that hit its O(n²) case
+    TypedBench typed = nullptr;
+};
+
+template <typename T>
+BenchResult measureSort(const function<void(vector<T>&)>& sortFunction, const vector<T>& input,
+                        const vector<T>& expected);
+
+// int -> T keeps the order of the values, so the converted expected output
+// is still the sorted input
+template <typename T>
+TypedBench benchAs(function<void(vector<T>&)> sortFunction) {
+    return [sortFunction](const vector<int>& input, const vector<int>& expected) {
+        vector<T> typedInput(input.begin(), input.end());
+        vector<T> typedExpected(expected.begin(), expected.end());
+        return measureSort(sortFunction, typedInput, typedExpected);
+    };
+}
+
+vector<BenchAlgorithm> benchAlgorithms() {
+    const size_t all = SIZE_MAX, big = 10000000;
+    vector<string> presorted = {"sorted", "reversed", "organ-pipe", "almost-sorted"};
+    vector<string> duplicates = {"few-unique", "zipf"};
+    vector<string> medianKillers = {"organ-pipe"};
+    vector<string> nonRandom = {"sorted", "reversed", "organ-pipe", "almost-sorted", "few-unique", "zipf"};
+    
+    return {
+        {"std::sort", [](vector<int>& a) { sort(a.begin(), a.end()); }, all, {}},
+        {"std::stable_sort", [](vector<int>& a) { stable_sort(a.begin(), a.end()); }, all, {}},
+        {"bubbleSort", [](vector<int>& a) { bubbleSort(a); }, BENCH_QUADRATIC_MAX, {}},
+        {"selectionSort", [](vector<int>& a) { selectionSort(a); }, BENCH_QUADRATIC_MAX, {}},
+        {"insertionSort", [](vector<int>& a) { insertionSort(a); }, BENCH_QUADRATIC_MAX, {}},
+        {"cocktailShakerSort", [](vector<int>& a) { cocktailShakerSort(a); }, BENCH_QUADRATIC_MAX, {}},
+        {"mergeSort", [](vector<int>& a) { mergeSort(a); }, all, {}},
+        {"quickSort", [](vector<int>& a) { quickSort(a); }, all, presorted},
+        {"quickSortRandom", [](vector<int>& a) { quickSortRandom(a); }, all, duplicates},
+        {"quickSortMedian", [](vector<int>& a) { quickSortMedian(a); }, all, medianKillers},
+        {"quickSortIterative", [](vector<int>& a) { quickSortIterative(a); }, all, nonRandom},
+        {"quickSort3Way", [](vector<int>& a) { quickSort3Way(a); }, all, presorted},
+        {"heapSort", [](vector<int>& a) { heapSort(a); }, all, {}},
+        {"countingSort", [](vector<int>& a) { countingSort(a); }, all, {}},
+        {"radixSort", [](vector<int>& a) { radixSort(a); }, all, {}},
+        {"shellSort", [](vector<int>& a) { shellSort(a); }, big, {}},
+        {"combSort", [](vector<int>& a) { combSort(a); }, big, {}},
+        {"parallelMergeSort", [](vector<int>& a) { parallelMergeSort(a); }, all, {}},
+        {"parallelQuickSort", [](vector<int>& a) { parallelQuickSort(a); }, all, {}},
+        {"pdqSort", [](vector<int>& a) { pdqSort(a); }, all, {}},
+        {"parallelRadixSort", [](vector<int>& a) { parallelRadixSort(a); }, all, {}},
+        {"fastSort", [](vector<int>& a) { fastSort(a.begin(), a.end()); }, all, {}},
+        {"adaptiveMergeSort", [](vector<int>& a) { adaptiveMergeSort(a); }, all, {}},
+        {"blockMergeSort", [](vector<int>& a) { blockMergeSort(a); }, all, {}},
+        {"autoSort", [](vector<int>& a) { autoSort(a); }, all, {}},
+        {"radixSort<float>", nullptr, all, {}, benchAs<float>([](vector<float>& a) { radixSort(a); })},
+        {"radixSort<double>", nullptr, all, {}, benchAs<double>([](vector<double>& a) { radixSort(a); })},
+        {"radixSort<int64>", nullptr, all, {}, benchAs<int64_t>([](vector<int64_t>& a) { radixSort(a); })},
+        {"sampleSort<float>", nullptr, all, {}, benchAs<float>([](vector<float>& a) { sampleSort(a); })},
+        {"sampleSort<double>", nullptr, all, {}, benchAs<double>([](vector<double>& a) { sampleSort(a); })},
+    };
+}
+
+vector<string> benchDistributions() {
+    return {"uniform", "sorted", "reversed", "few-unique", "organ-pipe", "zipf", "almost-sorted"};
+}
+
+// Same (seed, distribution, size) always gives the same input
+vector<int> makeBenchInput(const string& distribution, size_t n, uint64_t seed) {
+    seed_seq seq{seed, (uint64_t)hash<string>()(distribution), (uint64_t)n};
+    mt19937_64 rng(seq);
+    vector<int> input(n);
+    
+    if (distribution == "uniform") {
+        for (int& x : input) x = (int)rng();
+    } else if (distribution == "sorted") {
+        for (size_t i = 0; i < n; i++) input[i] = (int)i;
+    } else if (distribution == "reversed") {
+        for (size_t i = 0; i < n; i++) input[i] = (int)(n - i);
+    } else if (distribution == "few-unique") {
+        for (int& x : input) x = (int)(rng() % 16);
+    } else if (distribution == "organ-pipe") {
+        for (size_t i = 0; i < n; i++) input[i] = (int)min(i, n - i);
+    } else if (distribution == "zipf") {
+        // Rank k drawn with probability proportional to 1/k, via the inverse CDF
+        size_t ranks = max<size_t>(1, min<size_t>(n, 1 << 20));
+        vector<double> cdf(ranks);
+        double sum = 0;
+        for (size_t k = 0; k < ranks; k++) cdf[k] = sum += 1.0 / (k + 1);
         
-        swapped = false;
+        uniform_real_distribution<double> uniform(0, sum);
+        for (int& x : input) x = (int)(lower_bound(cdf.begin(), cdf.end(), uniform(rng)) - cdf.begin());
+    } else if (distribution == "almost-sorted") {
+        // Sorted, then 1% of the elements swapped with random partners
+        for (size_t i = 0; i < n; i++) input[i] = (int)i;
+        for (size_t s = 0; s < n / 200; s++) swap(input[rng() % n], input[rng() % n]);
+    } else {
+        throw invalid_argument("unknown distribution: " + distribution);
+    }
+    
+    return input;
+}
+
+// Best of as many repetitions as fit in BENCH_MIN_SECONDS (at least one);
+// the fastest run is the one least disturbed by the rest of the machine
+template <typename T>
+BenchResult measureSort(const function<void(vector<T>&)>& sortFunction, const vector<T>& input,
+                        const vector<T>& expected) {
+    BenchResult result = {1e300, 0, 0, true};
+    vector<T> work;
+    double totalSeconds = 0;
+    
+    // Start from an empty workspace, so the first run shows the scratch the
+    // sort needs in peakBytes and the later runs time the steady state
+    SortWorkspace::local().trim();
+    
+    do {
+        work = input;
+        size_t base = heapBytesInUse.load();
+        heapBytesPeak.store(base);
         
-        // Compare all elements with current gap
-        for (int i = 0; i < n - gap; i++) {
-            if (arr[i] > arr[i + gap]) {
-                swap(arr[i], arr[i + gap]);
-                swapped = true;
+        auto start = chrono::steady_clock::now();
+        sortFunction(work);
+        auto end = chrono::steady_clock::now();
+        
+        double seconds = chrono::duration<double>(end - start).count();
+        totalSeconds += seconds;
+        result.nsPerElement = min(result.nsPerElement, seconds * 1e9 / max<size_t>(1, input.size()));
+        result.peakBytes = max(result.peakBytes, heapBytesPeak.load() - base);
+        result.reps++;
+        
+        if (!expected.empty() && work != expected) result.correct = false;
+    } while (totalSeconds < BENCH_MIN_SECONDS && result.reps < BENCH_MAX_REPS);
+    
+    return result;
+}
+
+// Comma-separated list; an empty value keeps the defaults
+vector<string> splitList(const string& text) {
+    vector<string> items;
+    size_t start = 0;
+    while (start <= text.size() && !text.empty()) {
+        size_t comma = text.find(',', start);
+        if (comma == string::npos) comma = text.size();
+        if (comma > start) items.push_back(text.substr(start, comma - start));
+        start = comma + 1;
+    }
+    return items;
+}
+
+int runBenchmarks(int argc, char** argv) {
+    vector<size_t> sizes = {100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+    vector<string> distributions = benchDistributions();
+    vector<string> selected;
+    uint64_t seed = 42;
+    string jsonPath;
+    
+    for (int i = 2; i < argc; i++) {
+        string arg = argv[i];
+        size_t eq = arg.find('=');
+        string key = arg.substr(0, eq), value = eq == string::npos ? "" : arg.substr(eq + 1);
+        
+        if (key == "--sizes") {
+            sizes.clear();
+            for (const string& s : splitList(value)) sizes.push_back((size_t)stod(s));
+        } else if (key == "--distributions") {
+            distributions = splitList(value);
+        } else if (key == "--algorithms") {
+            selected = splitList(value);
+        } else if (key == "--seed") {
+            seed = stoull(value);
+        } else if (key == "--json") {
+            jsonPath = value;
+        } else if (key == "--huge-pages") {
+            SortWorkspace::local().setHugePages(true);
+        } else {
+            cerr << "unknown option: " << arg << endl;
+            return 1;
+        }
+    }
+    
+    vector<BenchAlgorithm> algorithms = benchAlgorithms();
+    auto isSelected = [&](const string& name) {
+        return selected.empty() || find(selected.begin(), selected.end(), name) != selected.end();
+    };
+    
+    string json = "{\n  \"seed\": " + to_string(seed) + ",\n  \"threads\": " + to_string(sortThreadCount()) +
+                  ",\n  \"networkKernel\": \"" + SORTING_NETWORK_KERNEL + "\",\n  \"results\": [";
+    bool firstResult = true, allCorrect = true;
+    
+    for (const string& distribution : distributions) {
+        for (size_t n : sizes) {
+            vector<int> input = makeBenchInput(distribution, n, seed);
+            vector<int> expected = input;
+            sort(expected.begin(), expected.end());
+            
+            // Baselines are timed even when not selected, for the speedups
+            double stdSortNs = measureSort(algorithms[0].sort, input, expected).nsPerElement;
+            double stableSortNs = measureSort(algorithms[1].sort, input, expected).nsPerElement;
+            
+            printf("\n%s, n = %zu\n", distribution.c_str(), n);
+            printf("  %-20s %10s %10s %10s %9s %9s\n", "algorithm", "ns/elem", "Melem/s", "peak MB",
+                   "vs sort", "vs stable");
+            
+            for (const BenchAlgorithm& algorithm : algorithms) {
+                if (!isSelected(algorithm.name)) continue;
+                
+                size_t limit = algorithm.maxSize;
+                if (find(algorithm.quadraticOn.begin(), algorithm.quadraticOn.end(), distribution) !=
+                    algorithm.quadraticOn.end())
+                    limit = min(limit, BENCH_QUADRATIC_MAX);
+                if (n > limit) continue;
+                
+                BenchResult r = algorithm.typed ? algorithm.typed(input, expected)
+                                                : measureSort(algorithm.sort, input, expected);
+                double throughput = 1e3 / max(r.nsPerElement, 1e-9);
+                allCorrect = allCorrect && r.correct;
+                
+                printf("  %-20s %10.2f %10.1f %10.2f %8.2fx %8.2fx%s\n", algorithm.name.c_str(), r.nsPerElement,
+                       throughput, r.peakBytes / 1048576.0, stdSortNs / r.nsPerElement,
+                       stableSortNs / r.nsPerElement, r.correct ? "" : "  WRONG");
+                
+                char line[512];
+                snprintf(line, sizeof(line),
+                         "%s\n    {\"algorithm\": \"%s\", \"distribution\": \"%s\", \"size\": %zu, "
+                         "\"reps\": %d, \"nsPerElement\": %.4f, \"elementsPerSecond\": %.0f, "
+                         "\"peakBytes\": %zu, \"speedupVsStdSort\": %.4f, \"speedupVsStdStableSort\": %.4f, "
+                         "\"correct\": %s}",
+                         firstResult ? "" : ",", algorithm.name.c_str(), distribution.c_str(), n, r.reps,
+                         r.nsPerElement, throughput * 1e6, r.peakBytes, stdSortNs / r.nsPerElement,
+                         stableSortNs / r.nsPerElement, r.correct ? "true" : "false");
+                json += line;
+                firstResult = false;
             }
         }
     }
+    
+    json += "\n  ]\n}\n";
+    if (!jsonPath.empty()) {
+        ofstream out(jsonPath);
+        out << json;
+        if (!out) {
+            cerr << "cannot write " << jsonPath << endl;
+            return 1;
+        }
+        cout << "\nResults written to " << jsonPath << endl;
+    }
+    
+    return allCorrect ? 0 : 2;
 }
 
 // ==========================================================================
 // MAIN FUNCTION - TESTING ALL SORTING ALGORITHMS
 // ==========================================================================
 
-int main() {
+int main(int argc, char** argv) {
+    if (argc > 1 && string(argv[1]) == "--bench")
+        return runBenchmarks(argc, argv);
+    
     // Test data
     vector<int> originalArr = {64, 34, 25, 12, 22, 11, 90, 5, 77, 30};
     
     cout << "SORTING ALGORITHMS DEMONSTRATION" << endl;
     cout << "================================" << endl;
-    cout << "Total algorithms implemented: 11" << endl;
     cout << "Array size: " << originalArr.size() << " elements" << endl;
     
     printArray(originalArr, "Original Array");
@@ -616,6 +5458,14 @@ int main() {
     quickSort3Way(duplicateArr);
     printArray(duplicateArr, "   5E. Three-Way Quick Sort");
     
+    vector<int> quickLarge(1 << 20);
+    for (int& x : quickLarge) x = rand();
+    vector<int> quickExpected = quickLarge;
+    pdqSort(quickExpected);
+    parallelQuickSort(quickLarge);
+    cout << "   5F. Parallel Quick Sort, 1M random ints match pdqSort: "
+         << (quickLarge == quickExpected ? "Yes" : "No") << endl;
+    
     // 6. Heap Sort
     cout << "\n6. HEAP SORT" << endl;
     cout << "   Time: O(n log n), Space: O(1), Stable: No" << endl;
@@ -623,9 +5473,19 @@ int main() {
     heapSort(arr);
     printArray(arr, "   Result");
     
-    // 7. Counting Sort (only for non-negative integers)
+    // The same heap as a priority queue: earliest deadline first
+    DaryHeap<int, 4, greater<int>> deadlines(originalArr);
+    deadlines.push(5);
+    cout << "   DaryHeap (min, 4-ary) pops: ";
+    while (!deadlines.empty()) {
+        cout << deadlines.top() << " ";
+        deadlines.pop();
+    }
+    cout << endl;
+    
+    // 7. Counting Sort (small key ranges; wide ones fall back to radix)
     cout << "\n7. COUNTING SORT" << endl;
-    cout << "   Time: O(n + k), Space: O(k), Stable: Yes" << endl;
+    cout << "   Time: O(n / p + p * k), Space: O(p * k), Stable: Yes" << endl;
     cout << "   Note: Works best with small range of integers" << endl;
     vector<int> positiveArr = {4, 2, 2, 8, 3, 3, 1};
     cout << "   Input : ";
@@ -634,17 +5494,45 @@ int main() {
     countingSort(positiveArr);
     printArray(positiveArr, "   Result");
     
-    // 8. Radix Sort (only for non-negative integers)
+    // Tens of millions of 8-bit category codes: histograms only, no copy
+    vector<uint8_t> codes(1 << 24), codesReference;
+    for (uint8_t& c : codes) c = rand() % 200;
+    codesReference = codes;
+    auto countingStart = chrono::steady_clock::now();
+    countingSort(codes);
+    auto countingMid = chrono::steady_clock::now();
+    sort(codesReference.begin(), codesReference.end());
+    auto countingEnd = chrono::steady_clock::now();
+    cout << "   16M uint8 codes: " << chrono::duration_cast<chrono::milliseconds>(countingMid - countingStart).count()
+         << " ms, std::sort " << chrono::duration_cast<chrono::milliseconds>(countingEnd - countingMid).count()
+         << " ms, match: " << (codes == codesReference ? "Yes" : "No") << endl;
+    
+    vector<int> sparseKeys = {1000000000, -2000000000, 7, 42, 7};
+    countingSort(sparseKeys);
+    printArray(sparseKeys, "   Sparse keys (radix fallback)");
+    
+    // 8. Radix Sort (full signed int range)
     cout << "\n8. RADIX SORT" << endl;
     cout << "   Time: O(d * (n + k)), Space: O(n + k), Stable: Yes" << endl;
-    cout << "   Note: d = number of digits, k = range of digits (0-9)" << endl;
-    vector<int> radixArr = {170, 45, 75, 90, 2, 802, 24, 66};
+    cout << "   Note: d = 4 byte passes (constant bytes skipped), k = 256 buckets" << endl;
+    vector<int> radixArr = {170, -45, 75, -90, 2, 802, 24, -66, 2147483647, -2147483647 - 1};
     cout << "   Input : ";
     for (int x : radixArr) cout << x << " ";
     cout << endl;
     radixSort(radixArr);
     printArray(radixArr, "   Result");
     
+    vector<double> floatKeys = {3.5, 0.0, -NAN, -1e300, -0.0, -INFINITY, 2.25, -7.5};
+    vector<double> totalKeys = floatKeys;
+    radixSort(floatKeys);
+    radixSort(totalKeys, FloatOrder::Total);
+    cout << "   Doubles (numeric) : ";
+    for (double x : floatKeys) cout << x << " ";
+    cout << endl;
+    cout << "   Doubles (total)   : ";
+    for (double x : totalKeys) cout << x << " ";
+    cout << endl;
+    
     // 9. Shell Sort
     cout << "\n9. SHELL SORT" << endl;
     cout << "   Time: O(n log n) to O(n²), Space: O(1), Stable: No" << endl;
@@ -666,6 +5554,445 @@ int main() {
     combSort(arr);
     printArray(arr, "    Result");
     
+    // 12. Parallel Merge Sort
+    cout << "\n12. PARALLEL MERGE SORT" << endl;
+    cout << "    Time: O(n log n / p), Space: O(n), Stable: Yes" << endl;
+    cout << "    Threads available: " << sortThreadCount() << endl;
+    arr = originalArr;
+    parallelMergeSort(arr);
+    printArray(arr, "    Result");
+    
+    vector<int> largeArr(1 << 20);
+    for (int& x : largeArr) x = rand() % 1000000;
+    vector<int> expectedArr = largeArr;
+    mergeSort(expectedArr);
+    parallelMergeSort(largeArr);
+    cout << "    1M random ints match mergeSort: " << (largeArr == expectedArr ? "Yes" : "No") << endl;
+    
+    // 13. Pattern-Defeating Quick Sort
+    cout << "\n13. PATTERN-DEFEATING QUICK SORT (INTROSORT)" << endl;
+    cout << "    Time: O(n log n) worst, Space: O(log n), Stable: No" << endl;
+    arr = originalArr;
+    pdqSort(arr);
+    printArray(arr, "    Result");
+    
+    // Inputs that push plain quick sort to O(n²)
+    int patternSize = 1 << 20;
+    vector<string> patternNames = {"random", "sorted", "reversed", "organ-pipe", "all-equal"};
+    for (int p = 0; p < (int)patternNames.size(); p++) {
+        vector<int> input(patternSize);
+        for (int i = 0; i < patternSize; i++) {
+            if (p == 0) input[i] = rand();
+            if (p == 1) input[i] = i;
+            if (p == 2) input[i] = patternSize - i;
+            if (p == 3) input[i] = min(i, patternSize - i);
+            if (p == 4) input[i] = 42;
+        }
+        
+        vector<int> mine = input, reference = input;
+        auto start = chrono::steady_clock::now();
+        pdqSort(mine);
+        auto mid = chrono::steady_clock::now();
+        sort(reference.begin(), reference.end());
+        auto end = chrono::steady_clock::now();
+        
+        cout << "    1M " << patternNames[p] << ": pdqSort "
+             << chrono::duration_cast<chrono::milliseconds>(mid - start).count() << " ms, std::sort "
+             << chrono::duration_cast<chrono::milliseconds>(end - mid).count() << " ms, match: "
+             << (mine == reference ? "Yes" : "No") << endl;
+    }
+    
+    // 14. Parallel Radix Sort
+    cout << "\n14. PARALLEL RADIX SORT" << endl;
+    cout << "    Time: O(d * n / p), Space: O(n + p * k), Stable: Yes" << endl;
+    arr = originalArr;
+    parallelRadixSort(arr);
+    printArray(arr, "    Result");
+    
+    vector<int> radixLarge(1 << 22);
+    for (int& x : radixLarge) x = (int)(((unsigned)rand() << 16) ^ (unsigned)rand());
+    vector<int> radixExpected = radixLarge;
+    radixSort(radixExpected);
+    parallelRadixSort(radixLarge);
+    cout << "    4M random ints match radixSort: " << (radixLarge == radixExpected ? "Yes" : "No") << endl;
+    
+    // 15. Sorting Networks (leaf case of merge and quick sort)
+    cout << "\n15. SORTING NETWORKS (blocks of up to " << SORTING_NETWORK_MAX << " ints)" << endl;
+    cout << "    Time: O(n log² n) comparators, Space: O(1), Stable: No" << endl;
+    cout << "    Kernel: " << SORTING_NETWORK_KERNEL << endl;
+    arr = originalArr;
+    sortSmallBlock(arr.data(), arr.size());
+    printArray(arr, "    Result");
+    
+    int blockCount = 1 << 15;
+    vector<int> blocks(blockCount * SORTING_NETWORK_MAX);
+    for (int& x : blocks) x = rand();
+    vector<int> networkBlocks = blocks, insertionBlocks = blocks;
+    
+    auto networkStart = chrono::steady_clock::now();
+    for (int b = 0; b < blockCount; b++)
+        sortSmallBlock(&networkBlocks[b * SORTING_NETWORK_MAX], SORTING_NETWORK_MAX);
+    auto networkEnd = chrono::steady_clock::now();
+    for (int b = 0; b < blockCount; b++)
+        insertionSortRange(insertionBlocks, b * SORTING_NETWORK_MAX, (b + 1) * SORTING_NETWORK_MAX - 1);
+    auto insertionEnd = chrono::steady_clock::now();
+    
+    cout << "    32K blocks of 64: network "
+         << chrono::duration_cast<chrono::microseconds>(networkEnd - networkStart).count() << " us, insertion "
+         << chrono::duration_cast<chrono::microseconds>(insertionEnd - networkEnd).count() << " us, match: "
+         << (networkBlocks == insertionBlocks ? "Yes" : "No") << endl;
+    
+    // 16. Generic Sorts (iterators, comparators, projections)
+    cout << "\n16. GENERIC SORTS (any element type, comparator and key)" << endl;
+    cout << "    Same algorithms as templates: sort(first, last, comp, proj)" << endl;
+    
+    vector<uint64_t> ids = {9000000000ULL, 42, 7, 18446744073709551615ULL, 1000};
+    radixSort(ids.begin(), ids.end());
+    cout << "    uint64 IDs (radix): ";
+    for (uint64_t id : ids) cout << id << " ";
+    cout << endl;
+    
+    vector<double> prices = {3.5, -1.25, 99.0, 0.0, 42.75};
+    quickSort(prices.begin(), prices.end(), greater<double>());
+    cout << "    Doubles, descending (quick): ";
+    for (double price : prices) cout << price << " ";
+    cout << endl;
+    
+    struct Employee { string name; int age; };
+    vector<Employee> staff = {{"Ana", 31}, {"Bo", 25}, {"Cy", 31}, {"Di", 25}, {"Ed", 40}};
+    mergeSort(staff.begin(), staff.end(), less<>(), &Employee::age);
+    cout << "    Structs by age (stable merge): ";
+    for (const Employee& e : staff) cout << e.name << "(" << e.age << ") ";
+    cout << endl;
+    
+    int rawBuffer[] = {5, -3, 9, 0, -3, 12, 7};
+    heapSort(begin(rawBuffer), end(rawBuffer));
+    cout << "    Raw int buffer (heap): ";
+    for (int x : rawBuffer) cout << x << " ";
+    cout << endl;
+    
+    vector<string> words = {"pear", "fig", "banana", "kiwi", "apple"};
+    fastSort(words.begin(), words.end(), less<>(), [](const string& w) { return w.size(); });
+    cout << "    Strings by length (fastSort): ";
+    for (const string& w : words) cout << w << " ";
+    cout << endl;
+    
+    // 17. Loser Tree K-Way Merge
+    cout << "\n17. LOSER TREE K-WAY MERGE" << endl;
+    cout << "    Time: O(n log k), Space: O(k), Stable: Yes" << endl;
+    
+    vector<vector<int>> sortedRuns = {{1, 4, 9}, {2, 3, 10, 11}, {}, {0, 5, 6}, {7, 8}};
+    vector<SortedRun<int>> runRanges;
+    for (const vector<int>& run : sortedRuns)
+        runRanges.push_back({run.data(), run.data() + run.size()});
+    vector<int> mergedRuns(12);
+    kWayMerge(runRanges, mergedRuns.data());
+    printArray(mergedRuns, "    5 runs merged");
+    
+    int runCount = 1000, runLength = 1000;
+    vector<int> manyRuns(runCount * runLength);
+    for (int& x : manyRuns) x = rand() % 100000;
+    runRanges.clear();
+    for (int r = 0; r < runCount; r++) {
+        sort(manyRuns.begin() + r * runLength, manyRuns.begin() + (r + 1) * runLength);
+        runRanges.push_back({&manyRuns[r * runLength], &manyRuns[r * runLength] + runLength});
+    }
+    vector<int> serialMerged(manyRuns.size()), parallelMerged(manyRuns.size());
+    kWayMerge(runRanges, serialMerged.data());
+    parallelKWayMerge(runRanges, parallelMerged.data());
+    vector<int> expectedMerged = manyRuns;
+    sort(expectedMerged.begin(), expectedMerged.end());
+    cout << "    1000 runs x 1000 ints, serial and parallel match: "
+         << (serialMerged == expectedMerged && parallelMerged == expectedMerged ? "Yes" : "No") << endl;
+    
+    // 18. Adaptive Merge Sort (powersort over natural runs)
+    cout << "\n18. ADAPTIVE MERGE SORT (POWERSORT)" << endl;
+    cout << "    Time: O(n) sorted, O(n log r) for r runs, Space: O(n), Stable: Yes" << endl;
+    arr = originalArr;
+    adaptiveMergeSort(arr);
+    printArray(arr, "    Result");
+    
+    // Inputs that already carry most of their order
+    int adaptiveSize = 1 << 20;
+    vector<string> adaptiveNames = {"random", "sorted", "appended 1%", "4 sorted runs", "1% swapped"};
+    for (int p = 0; p < (int)adaptiveNames.size(); p++) {
+        vector<int> input(adaptiveSize);
+        for (int i = 0; i < adaptiveSize; i++) input[i] = p == 0 ? rand() : i;
+        if (p == 2)
+            for (int i = adaptiveSize - adaptiveSize / 100; i < adaptiveSize; i++) input[i] = rand() % adaptiveSize;
+        if (p == 3)
+            for (int i = 0; i < adaptiveSize; i++) input[i] = (i % (adaptiveSize / 4)) * 4 + i / (adaptiveSize / 4);
+        if (p == 4)
+            for (int i = 0; i < adaptiveSize / 100; i++) swap(input[rand() % adaptiveSize], input[rand() % adaptiveSize]);
+        
+        vector<int> mine = input, reference = input;
+        auto start = chrono::steady_clock::now();
+        adaptiveMergeSort(mine);
+        auto mid = chrono::steady_clock::now();
+        mergeSort(reference);
+        auto end = chrono::steady_clock::now();
+        
+        cout << "    1M " << adaptiveNames[p] << ": adaptive "
+             << chrono::duration_cast<chrono::milliseconds>(mid - start).count() << " ms, mergeSort "
+             << chrono::duration_cast<chrono::milliseconds>(end - mid).count() << " ms, match: "
+             << (mine == reference ? "Yes" : "No") << endl;
+    }
+    
+    // 19. Auto Sort (profile the input, then dispatch)
+    cout << "\n19. AUTO SORT (INPUT-AWARE DISPATCH)" << endl;
+    cout << "    Profile: O(n) pass + 256-element sample, then the best-fitting sort" << endl;
+    
+    int autoSize = 1 << 20;
+    vector<string> autoNames = {"random", "sorted", "reversed", "1% swapped", "keys 0..999", "16 wide keys", "small (200)"};
+    for (int p = 0; p < (int)autoNames.size(); p++) {
+        vector<int> input(p == 6 ? 200 : autoSize);
+        for (int i = 0; i < (int)input.size(); i++) {
+            if (p == 0 || p == 6) input[i] = rand();
+            if (p == 1 || p == 3) input[i] = i;
+            if (p == 2) input[i] = autoSize - i;
+            if (p == 4) input[i] = rand() % 1000;
+            if (p == 5) input[i] = (rand() % 16) * 100000000;
+        }
+        if (p == 3)
+            for (int i = 0; i < autoSize / 200; i++) swap(input[rand() % autoSize], input[rand() % autoSize]);
+        
+        vector<int> mine = input, reference = input;
+        OpStats stats;
+        auto start = chrono::steady_clock::now();
+        autoSort(mine, stats);
+        auto mid = chrono::steady_clock::now();
+        sort(reference.begin(), reference.end());
+        auto end = chrono::steady_clock::now();
+        
+        cout << "    " << autoNames[p] << ": " << stats.algorithm << " (" << stats.reason << "), "
+             << chrono::duration_cast<chrono::microseconds>(mid - start).count() << " us vs std::sort "
+             << chrono::duration_cast<chrono::microseconds>(end - mid).count() << " us, match: "
+             << (mine == reference ? "Yes" : "No") << endl;
+    }
+    
+    // 20. Bucket / Sample Sort (floating point, any range)
+    cout << "\n20. BUCKET (SAMPLE) SORT" << endl;
+    cout << "    Time: O(n log n / p), Space: O(n), Stable: No, NaNs last" << endl;
+    
+    vector<float> floats = {3.5f, -1.25f, NAN, 1e30f, -0.0f, 0.75f, -INFINITY, 2.0f};
+    bucketSort(floats);
+    cout << "    Floats: ";
+    for (float x : floats) cout << x << " ";
+    cout << endl;
+    
+    vector<double> doubles(1 << 22), doublesReference;
+    for (double& x : doubles) x = (rand() - RAND_MAX / 2) * 1e-3;
+    doublesReference = doubles;
+    auto sampleStart = chrono::steady_clock::now();
+    sampleSort(doubles);
+    auto sampleMid = chrono::steady_clock::now();
+    sort(doublesReference.begin(), doublesReference.end());
+    auto sampleEnd = chrono::steady_clock::now();
+    cout << "    4M doubles: sampleSort " << chrono::duration_cast<chrono::milliseconds>(sampleMid - sampleStart).count()
+         << " ms, std::sort " << chrono::duration_cast<chrono::milliseconds>(sampleEnd - sampleMid).count()
+         << " ms, match: " << (doubles == doublesReference ? "Yes" : "No") << endl;
+    
+    // 21. External Merge Sort (files larger than the memory budget)
+    cout << "\n21. EXTERNAL MERGE SORT" << endl;
+    cout << "    Time: O(n log n), I/O: O(n) per merge pass, Space: memory budget" << endl;
+    
+    string externalInput = (filesystem::temp_directory_path() / "sorting-demo-input.bin").string();
+    string externalOutput = (filesystem::temp_directory_path() / "sorting-demo-output.bin").string();
+    vector<int> externalKeys(1 << 21);
+    for (int& x : externalKeys) x = (int)(((unsigned)rand() << 16) ^ (unsigned)rand());
+    
+    FILE* demoFile = fopen(externalInput.c_str(), "wb");
+    fwrite(externalKeys.data(), sizeof(int), externalKeys.size(), demoFile);
+    fclose(demoFile);
+    
+    ExternalSortOptions externalOptions;
+    externalOptions.memoryBudget = 1 << 20; // 1 MB for 8 MB of keys
+    ExternalSortStats externalStats = externalSort<int>(externalInput, externalOutput, externalOptions);
+    
+    vector<int> externalResult(externalKeys.size());
+    demoFile = fopen(externalOutput.c_str(), "rb");
+    size_t externalRead = fread(externalResult.data(), sizeof(int), externalResult.size(), demoFile);
+    fclose(demoFile);
+    filesystem::remove(externalInput);
+    filesystem::remove(externalOutput);
+    
+    radixSort(externalKeys);
+    cout << "    8 MB of keys, 1 MB budget: " << externalStats.runs << " runs, "
+         << externalStats.mergePasses << " merge passes, "
+         << externalStats.bytesRead / (1 << 20) << " MB read, "
+         << externalStats.bytesWritten / (1 << 20) << " MB written" << endl;
+    cout << "    Output sorted correctly: "
+         << (externalRead == externalKeys.size() && externalResult == externalKeys ? "Yes" : "No") << endl;
+    
+    // 22. Selection (median, smallest k, largest k without a full sort)
+    cout << "\n22. SELECTION" << endl;
+    cout << "    Time: O(n) select, O(n + k log k) partial sort, O(n log k) streaming top-k" << endl;
+    arr = originalArr;
+    nthElement(arr, arr.size() / 2);
+    cout << "    Median (nthElement): " << arr[arr.size() / 2] << endl;
+    arr = originalArr;
+    partialSort(arr, 3);
+    printArray(arr, "    partialSort(3)");
+    
+    vector<int> scores(1 << 20);
+    for (int& x : scores) x = rand();
+    vector<int> bestScores = topK(scores.begin(), scores.end(), 5);
+    cout << "    Top 5 of 1M scores (TopK): ";
+    for (int x : bestScores) cout << x << " ";
+    cout << endl;
+    
+    // 23. Key/Payload Sorting (keys and payloads in separate arrays)
+    cout << "\n23. KEY/PAYLOAD SORTING" << endl;
+    cout << "    Radix/merge: stable, O(n) space; quick: in place; payloads > 16 bytes move once" << endl;
+    vector<int> ages = {34, 25, 41, 25, 30};
+    vector<string> names = {"Asha", "Ben", "Chen", "Dara", "Eli"};
+    vector<int> byAge = argsort(ages);
+    radixSortByKey(ages, names);
+    cout << "    radixSortByKey: ";
+    for (size_t i = 0; i < ages.size(); i++) cout << names[i] << "(" << ages[i] << ") ";
+    cout << endl;
+    cout << "    argsort       : ";
+    for (int i : byAge) cout << i << " ";
+    cout << endl;
+    
+    vector<string> shuffled = {"c", "a", "d", "b"};
+    vector<int> order = {1, 3, 0, 2};
+    applyPermutation(shuffled, order);
+    cout << "    applyPermutation {1, 3, 0, 2} on c a d b: ";
+    for (const string& x : shuffled) cout << x << " ";
+    cout << endl;
+    
+    // 24. Block Merge Sort (stable with O(1) extra memory)
+    cout << "\n24. BLOCK MERGE SORT" << endl;
+    vector<pair<int, char>> cards = {{3, 'a'}, {1, 'b'}, {3, 'c'}, {2, 'd'}, {1, 'e'}, {3, 'f'}};
+    blockMergeSort(cards.begin(), cards.end(), less<>(), &pair<int, char>::first);
+    cout << "    Ties keep input order: ";
+    for (const auto& c : cards) cout << c.first << c.second << " ";
+    cout << endl;
+    arr = originalArr;
+    blockMergeSort(arr);
+    printArray(arr, "    Sorted");
+    
+    // 25. Incremental Sort (appends merged into a sorted array)
+    cout << "\n25. INCREMENTAL SORT" << endl;
+    vector<int> ledger = {5, 11, 12, 22, 25};
+    size_t sortedUpTo = incrementalSort(ledger, 0);
+    for (int x : {30, 7, 90}) ledger.push_back(x);
+    sortedUpTo = incrementalSort(ledger, sortedUpTo);
+    printArray(ledger, "    After appending 30 7 90");
+    
+    vector<int> big(1 << 20);
+    for (int& x : big) x = rand();
+    sortedUpTo = incrementalSort(big, 0);
+    auto incrementalStart = chrono::steady_clock::now();
+    for (int b = 0; b < 10; b++) {
+        for (int i = 0; i < 1000; i++) big.push_back(rand());
+        sortedUpTo = incrementalSort(big, sortedUpTo);
+    }
+    auto incrementalEnd = chrono::steady_clock::now();
+    cout << "    10 batches of 1000 appended to 1M sorted ints: "
+         << chrono::duration_cast<chrono::microseconds>(incrementalEnd - incrementalStart).count() / 10
+         << " us per batch, sorted: " << (is_sorted(big.begin(), big.end()) ? "yes" : "no") << endl;
+    
+    // 26. String Sorting (views sorted in place, bytes never copied)
+    cout << "\n26. STRING SORTING" << endl;
+    vector<string> urls = {"https://example.com/b", "https://example.com/a/2", "http://example.org",
+                           "https://example.com/a", "https://example.com/a/10", "ftp://example.net"};
+    vector<string_view> urlViews(urls.begin(), urls.end());
+    multikeyQuickSort(urlViews);
+    cout << "    Multikey quick sort:";
+    for (string_view u : urlViews) cout << " " << u;
+    cout << endl;
+    
+    vector<string> pages(1 << 18);
+    for (string& page : pages) {
+        page = "https://example.com/";
+        for (int k = rand() % 12 + 1; k > 0; k--) page += (char)('a' + rand() % 26);
+    }
+    vector<string_view> pageViews(pages.begin(), pages.end());
+    msdRadixSort(pageViews);
+    cout << "    MSD radix, 256K URLs sorted: " << (is_sorted(pageViews.begin(), pageViews.end()) ? "yes" : "no")
+         << endl;
+    
+    // 27. Multi-Column ORDER BY (one normalized key per row)
+    cout << "\n27. MULTI-COLUMN ORDER BY" << endl;
+    vector<int> region = {2, 1, 2, 1, 1, 2};
+    vector<double> revenue = {9.5, 4.0, 9.5, 0.0, 7.25, 3.0};
+    vector<bool> revenueNull = {false, false, false, true, false, false};
+    vector<string> customerNames = {"zoe", "amir", "bea", "lin", "kai", "omar"};
+    vector<string_view> customers(customerNames.begin(), customerNames.end());
+    vector<int> rows = orderBy({SortColumn(region),
+                                SortColumn(revenue, SortDirection::Descending).withNulls(revenueNull),
+                                SortColumn(customers, 8)});
+    cout << "    ORDER BY region, revenue DESC NULLS LAST, customer:" << endl;
+    for (int row : rows) {
+        cout << "      " << region[row] << " ";
+        if (revenueNull[row]) cout << "NULL";
+        else cout << revenue[row];
+        cout << " " << customers[row] << endl;
+    }
+    
+    // Sort Workspace (scratch arrays reused across calls)
+    cout << "\nSORT WORKSPACE" << endl;
+    vector<int> batch(10000), batchInput(10000), batchKeys(10000), batchValues(10000);
+    vector<function<void()>> batchSorts = {
+        [&] { mergeSort(batch); },
+        [&] { quickSortIterative(batch); },
+        [&] { countingSort(batch); },
+        [&] { radixSort(batch); },
+        [&] { adaptiveMergeSort(batch); },
+        [&] { radixSortByKey(batchKeys, batchValues); },
+    };
+    auto runBatch = [&] {
+        for (int& x : batchInput) x = rand() % 50000;
+        for (const auto& sortBatch : batchSorts) {
+            copy(batchInput.begin(), batchInput.end(), batch.begin());
+            copy(batchInput.begin(), batchInput.end(), batchKeys.begin());
+            sortBatch();
+        }
+    };
+    SortWorkspace::setRetainLimit(1 << 20); // What the 1M-element demos above left is freed
+    runBatch();                             // Grows the workspace once
+    size_t heapBase = heapBytesInUse.load();
+    heapBytesPeak.store(heapBase);
+    for (int b = 0; b < 100; b++) runBatch();
+    cout << "    100 more batches of 10k ints through 6 sorts: " << heapBytesPeak.load() - heapBase
+         << " bytes of heap allocated, workspace holds " << SortWorkspace::local().capacity() << " bytes" << endl;
+    
+    // Operation counts from the same implementations, via the Stats policy
+    cout << "\nOPERATION COUNTS (2000 random ints)" << endl;
+    
+    vector<int> countInput(2000);
+    for (int& x : countInput) x = rand() % 100000;
+    vector<pair<string, function<void(vector<int>&, OpStats&)>>> counted = {
+        {"Bubble", [](vector<int>& a, OpStats& s) { bubbleSort(a, s); }},
+        {"Insertion", [](vector<int>& a, OpStats& s) { insertionSort(a, s); }},
+        {"Merge", [](vector<int>& a, OpStats& s) { mergeSort(a, s); }},
+        {"Quick (median-of-3)", [](vector<int>& a, OpStats& s) { quickSortMedian(a, s); }},
+        {"Quick (3-way)", [](vector<int>& a, OpStats& s) { quickSort3Way(a, s); }},
+        {"Heap", [](vector<int>& a, OpStats& s) { heapSort(a, s); }},
+        {"Shell", [](vector<int>& a, OpStats& s) { shellSort(a, s); }},
+        {"Comb", [](vector<int>& a, OpStats& s) { combSort(a, s); }},
+    };
+    for (const auto& entry : counted) {
+        OpStats stats;
+        arr = countInput;
+        entry.second(arr, stats);
+        printf("    %-20s %9llu comparisons %9llu swaps %9llu moves %7llu bytes allocated\n", entry.first.c_str(),
+               (unsigned long long)stats.comparisons, (unsigned long long)stats.swaps,
+               (unsigned long long)stats.moves, (unsigned long long)stats.bytesAllocated);
+    }
+    
+    PerfCounters perf;
+    vector<int> perfInput(1 << 20);
+    for (int& x : perfInput) x = rand();
+    perf.measure([&] { pdqSort(perfInput); });
+    cout << "    pdqSort 1M hardware counters:";
+    if (!perf.anyAvailable()) cout << " unavailable (perf_event_open not permitted)";
+    for (int e = 0; e < PerfCounters::EVENT_COUNT; e++)
+        if (perf.available(e)) cout << " " << PerfCounters::name(e) << "=" << perf.value(e);
+    cout << endl;
+    
     cout << "\n" << string(60, '=') << endl;
     cout << "ALGORITHM COMPARISON SUMMARY" << endl;
     cout << string(60, '=') << endl;
@@ -677,8 +6004,17 @@ int main() {
     
     cout << "\nBest for specific cases:" << endl;
     cout << "• Insertion Sort - Small arrays or nearly sorted" << endl;
+    cout << "• Adaptive Merge Sort - Large nearly sorted inputs, stable" << endl;
+    cout << "• Auto Sort - Unknown or mixed inputs: profiles, then dispatches" << endl;
     cout << "• Counting Sort - Small range of integers" << endl;
     cout << "• Radix Sort - Large integers with fixed digits" << endl;
+    cout << "• nthElement / partialSort / TopK - Medians and top-k without a full sort" << endl;
+    cout << "• Sort by key / argsort - Records with payloads, wide structs" << endl;
+    cout << "• Block Merge Sort - Stable sorting with no spare memory" << endl;
+    cout << "• Incremental Sort - Sorted arrays that keep receiving small appends" << endl;
+    cout << "• Multikey Quick Sort / MSD Radix - Strings and byte keys with long shared prefixes" << endl;
+    cout << "• orderBy - Multi-column ORDER BY over columnar rows, with NULLs and DESC" << endl;
+    cout << "• SortWorkspace - Many small sorts: scratch arrays are reused, not reallocated" << endl;
     
     cout << "\nTime Complexity Comparison:" << endl;
     cout << "┌─────────────────────┬─────────────┬─────────────┬─────────────┐" << endl;
@@ -695,22 +6031,28 @@ int main() {
     cout << "│ Shell Sort          │ O(n log n)  │ O(n^1.25)   │ O(n²)       │" << endl;
     cout << "│ Cocktail Sort       │ O(n)        │ O(n²)       │ O(n²)       │" << endl;
     cout << "│ Comb Sort           │ O(n log n)  │ O(n²/2^p)   │ O(n²)       │" << endl;
+    cout << "│ Parallel Merge Sort │ O(n log n/p)│ O(n log n/p)│ O(n log n/p)│" << endl;
+    cout << "│ Pattern-Def. Quick  │ O(n)        │ O(n log n)  │ O(n log n)  │" << endl;
+    cout << "│ Parallel Radix Sort │ O(nk/p)     │ O(nk/p)     │ O(nk/p)     │" << endl;
+    cout << "│ Sorting Network     │ O(n log² n) │ O(n log² n) │ O(n log² n) │" << endl;
+    cout << "│ Adaptive Merge Sort │ O(n)        │ O(n log n)  │ O(n log n)  │" << endl;
+    cout << "│ Block Merge Sort    │ O(n log n)  │ O(n log n)  │ O(n log n)  │" << endl;
     cout << "└─────────────────────┴─────────────┴─────────────┴─────────────┘" << endl;
     
     cout << "\nSpace Complexity:" << endl;
-    cout << "• O(1): Bubble, Selection, Insertion, Heap, Shell, Cocktail, Comb" << endl;
-    cout << "• O(log n): Quick Sort (recursion stack)" << endl;
-    cout << "• O(n): Merge Sort" << endl;
+    cout << "• O(1): Bubble, Selection, Insertion, Heap, Shell, Cocktail, Comb, Sorting Network, Block Merge" << endl;
+    cout << "• O(log n): Quick Sort (recursion stack), Pattern-Defeating Quick Sort" << endl;
+    cout << "• O(n): Merge Sort, Parallel Merge Sort (one ping-pong buffer), Adaptive Merge Sort" << endl;
     cout << "• O(k): Counting Sort (k = range of input)" << endl;
-    cout << "• O(n + k): Radix Sort" << endl;
+    cout << "• O(n + k): Radix Sort, Parallel Radix Sort (k per thread)" << endl;
     
     cout << "\nStability (maintains relative order of equal elements):" << endl;
-    cout << "• Stable: Bubble, Insertion, Merge, Counting, Radix, Cocktail" << endl;
-    cout << "• Not Stable: Selection, Quick, Heap, Shell, Comb" << endl;
+    cout << "• Stable: Bubble, Insertion, Merge, Parallel Merge, Adaptive Merge, Block Merge, Counting, Radix, Parallel Radix, Cocktail" << endl;
+    cout << "• Not Stable: Selection, Quick, Pattern-Defeating Quick, Heap, Shell, Comb, Sorting Network" << endl;
     
     cout << "\n" << string(60, '=') << endl;
     cout << "Program executed successfully!" << endl;
-    cout << "All " << 11 << " sorting algorithms implemented and tested." << endl;
+    cout << "All sorting algorithms implemented and tested." << endl;
     
     return 0;
 }